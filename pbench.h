@@ -0,0 +1,114 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки общих средств измерения производительности.
+ */
+
+/**
+ *  (PTL) Patriarch library : pbench.h
+ */
+
+#pragma once
+#if !defined( __PTL_PBENCH_H__ )
+#define __PTL_PBENCH_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#include <sys/resource.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/*
+ * Средства, общие для наборов замеров pgraphbench.h и
+ * pcontainerbench.h.
+ *
+ * Пик памяти за фазу - VmHWM из /proc/self/status после сброса пика
+ * перед фазой записью "5" в /proc/self/clear_refs (Linux). Если сброс
+ * недоступен, peak_rss_kb() возвращает пик процесса с его запуска
+ * (ru_maxrss): тогда фазы после самой большой повторяют ее пик.
+ *
+ * Функции:
+ *   - reset_peak_rss() - сброс пика резидентной памяти до текущего
+ *     объема
+ *   - peak_rss_kb() - пиковый объем резидентной памяти с последнего
+ *     сброса (или с запуска процесса)
+ *   - latency_percentile() - процентиль упорядоченных задержек
+ *
+ * @code
+ *   bool  per_phase = ptl::reset_peak_rss();
+ *   run_phase();
+ *   ptl::__u64  kb = ptl::peak_rss_kb();
+ * @endcode
+ */
+
+namespace ptl
+  {
+//--------------------------------------------------------------------
+// Сброс пика резидентной памяти процесса (VmHWM) до текущего объема.
+// Возвращает false, если сброс недоступен (не Linux или нет прав).
+  inline auto
+  reset_peak_rss() -> bool
+    {
+    std::FILE*  __f = std::fopen( "/proc/self/clear_refs", "w" );
+    if( __f == nullptr )
+      { return false; }
+
+    bool  __ok = std::fputs( "5", __f ) >= 0;
+    return std::fclose( __f ) == 0 && __ok;
+    }
+//--------------------------------------------------------------------
+// Пиковый объем резидентной памяти процесса в килобайтах: VmHWM из
+// /proc/self/status, то есть пик с последнего reset_peak_rss(); без
+// /proc - ru_maxrss, пик с запуска процесса.
+  inline auto
+  peak_rss_kb() -> __u64
+    {
+    std::FILE*  __f = std::fopen( "/proc/self/status", "r" );
+    if( __f != nullptr )
+      {
+      char   __line[256];
+      __u64  __kb{ 0 };
+      bool   __found{ false };
+
+      while( !__found && std::fgets( __line, sizeof( __line ), __f ) != nullptr )
+        {
+        if( std::strncmp( __line, "VmHWM:", 6 ) == 0 )
+          {
+          __kb    = std::strtoull( __line + 6, nullptr, 10 );
+          __found = true;
+          }
+        }
+      std::fclose( __f );
+
+      if( __found )
+        { return __kb; }
+      }
+
+    struct rusage  __ru;
+    if( getrusage( RUSAGE_SELF, &__ru ) != 0 )
+      { return 0; }
+    return static_cast<__u64>( __ru.ru_maxrss );
+    }
+//--------------------------------------------------------------------
+// Процентиль __p (от 0 до 1) упорядоченных по возрастанию значений,
+// по ближайшему рангу; для пустого набора - 0.
+  inline auto
+  latency_percentile( const std::vector<double>& __sorted, double __p ) -> double
+    {
+    if( __sorted.empty() )
+      { return 0.0; }
+
+    __u64  __rank = static_cast<__u64>( __p * static_cast<double>( __sorted.size() ) );
+    return __sorted[__rank < __sorted.size() ? __rank : __sorted.size() - 1];
+    }
+
+  } // namespace ptl
+
+#endif // __PTL_PBENCH_H__
@@ -0,0 +1,344 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для плотного графа на битовой матрице.
+ */
+
+/**
+ *  (PTL) Patriarch library : pbitgraph.h
+ */
+
+#pragma once
+#if !defined( __PTL_PBITGRAPH_H__ )
+#define __PTL_PBITGRAPH_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#if !defined( __PTL_PEXCEPT_H__ )
+#include "pexcept.h"
+#endif
+
+#include <vector>
+
+/*
+ * Плотный граф на битовой матрице смежности.
+ *
+ * Строка матрицы - множество соседей вершины, упакованное в 64-битные
+ * слова. Ячейка занимает один бит вместо __u32, а операции над
+ * множествами соседей выполняются целыми словами (AND/OR/popcount).
+ *
+ * Методы:
+ *   - is_exists_edge() - проверка существования ребра графа
+ *   - add_arc() - добавление дуги u -> v
+ *   - add_edge() - добавление ребра u <-> v
+ *   - del_arc() - удаление дуги u -> v
+ *   - del_edge() - удаление ребра u <-> v
+ *   - degree() - количество соседей вершины
+ *   - row() - строка матрицы смежности вершины (номер вершины не
+ *     проверяется)
+ *   - words() - количество 64-битных слов в строке
+ *   - bfs_levels() - обход в ширину по фронтам, расстояния в ребрах
+ *   - count_triangles() - количество треугольников неориентированного графа
+ *   - transitive_closure() - транзитивное замыкание (алгоритм Уоршелла)
+ *   - memory_bytes() - размер матрицы в байтах
+ *   - vertex_bound(), adj_begin(), adj_end(), adj_next(), adj_target() -
+ *     курсоры смежности для алгоритмов из ptraversal.h
+ *
+ * @code
+ *   ptl::pbitgraph graph( 4096 );
+ *   graph.add_arc( 0, 1 );
+ *   ptl::pbitgraph closure = graph.transitive_closure();
+ * @endcode
+ */
+
+namespace ptl
+  {
+//////////////////////////////////////////////////////////////////////
+  class pbitgraph
+    {
+    private:
+      __u32               _M_vertex_count; // Количество вершин
+      __u32               _M_words;        // Слов в строке матрицы
+      std::vector<__u64>  _M_bits;         // Матрица смежности по строкам
+
+      auto
+      check( __u32 __v ) const -> void
+        {
+        if( __v >= _M_vertex_count )
+          { throw pexception( "E: Такой вершины в графе нет." ); }
+        }
+//--------------------------------------------------------------------
+// Поиск первого установленного бита строки __v, начиная с __from.
+      auto
+      scan( __u32 __v, __u32 __from ) const -> __u32
+        {
+        if( __from >= _M_vertex_count )
+          { return _M_vertex_count; }
+
+        const __u64*  __r = row( __v );
+        __u32         __w = __from >> 6;
+        __u64         __x = __r[__w] & ( ~0ULL << ( __from & 63 ) );
+
+        while( __x == 0 )
+          {
+          if( ++__w == _M_words )
+            { return _M_vertex_count; }
+          __x = __r[__w];
+          }
+
+        return ( __w << 6 ) + static_cast<__u32>( __builtin_ctzll( __x ) );
+        }
+
+    public:
+      explicit
+      pbitgraph( __u32 __vertex_count )
+        : _M_vertex_count( __vertex_count ),
+          _M_words( ( __vertex_count + 63 ) / 64 ),
+          _M_bits( static_cast<__u64>( _M_words ) * __vertex_count, 0 )
+        { }
+
+      ~pbitgraph() noexcept
+        { }
+//--------------------------------------------------------------------
+// Проверка существования дуги __v1 -> __v2.
+      auto
+      is_exists_edge( __u32 __v1, __u32 __v2 ) const -> bool
+        {
+        check( __v1 );
+        check( __v2 );
+        return ( row( __v1 )[__v2 >> 6] >> ( __v2 & 63 ) ) & 1;
+        }
+//--------------------------------------------------------------------
+// Добавление дуги __v1 -> __v2.
+      auto
+      add_arc( __u32 __v1, __u32 __v2 ) -> void
+        {
+        check( __v1 );
+        check( __v2 );
+        row( __v1 )[__v2 >> 6] |= 1ULL << ( __v2 & 63 );
+        }
+//--------------------------------------------------------------------
+// Добавление ребра __v1 <-> __v2.
+      auto
+      add_edge( __u32 __v1, __u32 __v2 ) -> void
+        {
+        add_arc( __v1, __v2 );
+        add_arc( __v2, __v1 );
+        }
+//--------------------------------------------------------------------
+// Удаление дуги __v1 -> __v2.
+      auto
+      del_arc( __u32 __v1, __u32 __v2 ) -> void
+        {
+        check( __v1 );
+        check( __v2 );
+        row( __v1 )[__v2 >> 6] &= ~( 1ULL << ( __v2 & 63 ) );
+        }
+//--------------------------------------------------------------------
+// Удаление ребра __v1 <-> __v2.
+      auto
+      del_edge( __u32 __v1, __u32 __v2 ) -> void
+        {
+        del_arc( __v1, __v2 );
+        del_arc( __v2, __v1 );
+        }
+//--------------------------------------------------------------------
+// Количество соседей вершины.
+      auto
+      degree( __u32 __v ) const -> __u32
+        {
+        check( __v );
+
+        const __u64*  __r = row( __v );
+        __u32         __count{ 0 };
+
+        for( __u32 __w{ 0 }; __w < _M_words; __w++ )
+          { __count += static_cast<__u32>( __builtin_popcountll( __r[__w] ) ); }
+
+        return __count;
+        }
+//--------------------------------------------------------------------
+// Строка матрицы смежности вершины (words() слов). Номер вершины не
+// проверяется: метод для внутренних циклов, __v < vertex_bound().
+      auto
+      row( __u32 __v ) -> __u64*
+        { return _M_bits.data() + static_cast<__u64>( __v ) * _M_words; }
+
+      auto
+      row( __u32 __v ) const -> const __u64*
+        { return _M_bits.data() + static_cast<__u64>( __v ) * _M_words; }
+//--------------------------------------------------------------------
+// Количество 64-битных слов в строке матрицы.
+      auto
+      words() const -> __u32
+        { return _M_words; }
+//--------------------------------------------------------------------
+// Размер матрицы смежности в байтах.
+      auto
+      memory_bytes() const -> __u64
+        { return _M_bits.size() * sizeof( __u64 ); }
+//--------------------------------------------------------------------
+// Обход графа в ширину по фронтам.
+// Следующий фронт - объединение строк вершин текущего фронта за
+// вычетом уже посещенных. Возвращает расстояние в ребрах до каждой
+// вершины, для недостижимых - 0xFFFFFFFF.
+      auto
+      bfs_levels( __u32 __start ) const -> std::vector<__u32>
+        {
+        check( __start );
+
+        std::vector<__u32>  __level( _M_vertex_count, 0xFFFFFFFFu );
+        std::vector<__u64>  __visited( _M_words, 0 );
+        std::vector<__u64>  __frontier( _M_words, 0 );
+        std::vector<__u64>  __next( _M_words, 0 );
+
+        __level[__start] = 0;
+        __visited[__start >> 6]  |= 1ULL << ( __start & 63 );
+        __frontier[__start >> 6] |= 1ULL << ( __start & 63 );
+
+        for( __u32 __depth{ 1 }; ; __depth++ )
+          {
+          for( __u32 __w{ 0 }; __w < _M_words; __w++ )
+            { __next[__w] = 0; }
+
+          /** Расширение фронта: OR строк всех вершин фронта.
+           */
+          for( __u32 __fw{ 0 }; __fw < _M_words; __fw++ )
+            {
+            for( __u64 __x = __frontier[__fw]; __x != 0; __x &= __x - 1 )
+              {
+              __u32         __v = ( __fw << 6 )
+                                  + static_cast<__u32>( __builtin_ctzll( __x ) );
+              const __u64*  __r = row( __v );
+
+              for( __u32 __w{ 0 }; __w < _M_words; __w++ )
+                { __next[__w] |= __r[__w]; }
+              }
+            }
+
+          /** Отбрасываем посещенные и размечаем новый фронт.
+           */
+          bool  __empty{ true };
+
+          for( __u32 __w{ 0 }; __w < _M_words; __w++ )
+            {
+            __u64  __x = __next[__w] & ~__visited[__w];
+
+            __frontier[__w] = __x;
+            __visited[__w] |= __x;
+
+            for( ; __x != 0; __x &= __x - 1 )
+              {
+              __level[( __w << 6 )
+                      + static_cast<__u32>( __builtin_ctzll( __x ) )] = __depth;
+              __empty = false;
+              }
+            }
+
+          if( __empty )
+            { break; }
+          }
+
+        return __level;
+        }
+//--------------------------------------------------------------------
+// Количество треугольников неориентированного графа.
+// Для каждого ребра (u, v), u < v, считаются общие соседи w > v
+// пересечением строк u и v.
+      auto
+      count_triangles() const -> __u64
+        {
+        __u64  __count{ 0 };
+
+        for( __u32 __u{ 0 }; __u < _M_vertex_count; __u++ )
+          {
+          const __u64*  __ru = row( __u );
+
+          for( __u32 __v = scan( __u, __u + 1 );
+               __v < _M_vertex_count;
+               __v = scan( __u, __v + 1 ) )
+            {
+            const __u64*  __rv = row( __v );
+            __u32         __from = __v + 1;
+
+            if( __from >= _M_vertex_count )
+              { break; }
+
+            __u32  __w = __from >> 6;
+            __u64  __x = __ru[__w] & __rv[__w] & ( ~0ULL << ( __from & 63 ) );
+
+            __count += static_cast<__u64>( __builtin_popcountll( __x ) );
+
+            for( ++__w; __w < _M_words; __w++ )
+              {
+              __count +=
+                static_cast<__u64>( __builtin_popcountll( __ru[__w] & __rv[__w] ) );
+              }
+            }
+          }
+
+        return __count;
+        }
+//--------------------------------------------------------------------
+// Транзитивное замыкание (алгоритм Уоршелла).
+// Если i достигает k, то i достигает все, что достигает k: строка k
+// добавляется к строке i одним проходом OR по словам.
+      auto
+      transitive_closure() const -> pbitgraph
+        {
+        pbitgraph  __result( *this );
+
+        for( __u32 __k{ 0 }; __k < _M_vertex_count; __k++ )
+          {
+          const __u64*  __rk   = __result.row( __k );
+          __u32         __kw   = __k >> 6;
+          __u64         __kbit = 1ULL << ( __k & 63 );
+
+          for( __u32 __i{ 0 }; __i < _M_vertex_count; __i++ )
+            {
+            __u64*  __ri = __result.row( __i );
+
+            if( __ri[__kw] & __kbit )
+              {
+              for( __u32 __w{ 0 }; __w < _M_words; __w++ )
+                { __ri[__w] |= __rk[__w]; }
+              }
+            }
+          }
+
+        return __result;
+        }
+//--------------------------------------------------------------------
+// Верхняя граница номеров вершин графа.
+      auto
+      vertex_bound() const -> __u32
+        { return _M_vertex_count; }
+//--------------------------------------------------------------------
+// Курсор первого ребра вершины __v (номер соседа).
+      auto
+      adj_begin( __u32 __v ) const -> __u32
+        { return scan( __v, 0 ); }
+//--------------------------------------------------------------------
+// Курсор за последним ребром вершины __v.
+      auto
+      adj_end( __u32 ) const -> __u32
+        { return _M_vertex_count; }
+//--------------------------------------------------------------------
+// Курсор ребра, следующего за __c.
+      auto
+      adj_next( __u32 __v, __u32 __c ) const -> __u32
+        { return scan( __v, __c + 1 ); }
+//--------------------------------------------------------------------
+// Вершина, в которую ведет ребро __c.
+      auto
+      adj_target( __u32, __u32 __c ) const -> __u32
+        { return __c; }
+
+    }; // class pbitgraph
+  } // namespace ptl
+
+#endif // __PTL_PBITGRAPH_H__
@@ -0,0 +1,422 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для блокирующей очереди заданий.
+ */
+
+/**
+ *  (PTL) Patriarch library : pblocking_queue.h
+ */
+
+#pragma once
+#if !defined( __PTL_PBLOCKING_QUEUE_H__ )
+#define __PTL_PBLOCKING_QUEUE_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#if !defined( __PTL_PEXCEPT_H__ )
+#include "pexcept.h"
+#endif
+
+#if !defined( __PTL_PDEQUE_H__ )
+#include "pdeque.h"
+#endif
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/*
+ * Блокирующая очередь заданий между потоками: потребители спят на
+ * условной переменной, пока очередь пуста, а не опрашивают ее.
+ *
+ * Верхняя граница (high-water mark) ограничивает количество элементов:
+ * при заполненной очереди производитель либо ждет места
+ * (pbackpressure::block), либо получает отказ (pbackpressure::reject).
+ *
+ * Завершение работы: после close() новые элементы не принимаются,
+ * ждущие производители получают отказ, а потребители выбирают
+ * оставшиеся элементы и затем получают false - очередь "осушена".
+ *
+ * Методы:
+ *   - push() - вставка элемента (с ожиданием места или отказом)
+ *   - try_push() - вставка без ожидания
+ *   - pop_wait() - извлечение с ожиданием, в том числе с тайм-аутом
+ *   - try_pop() - извлечение без ожидания
+ *   - pop_batch() - извлечение до n элементов за одну блокировку
+ *   - close() - закрытие очереди для производителей
+ *   - wait_drained() - ожидание опустошения закрытой очереди
+ *   - is_closed(), is_drained() - состояние очереди
+ *   - depth() - текущее количество элементов
+ *   - stats() - счетчики глубины, отказов и времени ожидания
+ *
+ * @code
+ *   ptl::pblocking_queue<job> queue( 1024 );
+ *   // производитель               // рабочий поток
+ *   queue.push( std::move( j ) );   std::vector<job> batch;
+ *   ...                             while( queue.pop_batch( batch, 64 ) )
+ *   queue.close();                    { ... batch.clear(); }
+ * @endcode
+ */
+
+namespace ptl
+  {
+  /*
+   * Поведение производителя при заполненной очереди.
+   */
+  enum class pbackpressure
+    {
+    block,  // Ждать места
+    reject  // Отказать сразу
+    };
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Счетчики очереди. Времена ожидания - в наносекундах; учитываются
+   * только вызовы, которые действительно ждали.
+   */
+  struct pqueue_stats
+    {
+    __u64  _S_depth{ 0 };             // Текущее количество элементов
+    __u64  _S_max_depth{ 0 };         // Наибольшее количество элементов
+    __u64  _S_pushed{ 0 };            // Принято элементов
+    __u64  _S_popped{ 0 };            // Выдано элементов
+    __u64  _S_rejected{ 0 };          // Отказов производителям
+    __u64  _S_producer_waits{ 0 };    // Ожиданий места
+    __u64  _S_producer_wait_ns{ 0 };  // Суммарное время ожидания места
+    __u64  _S_consumer_waits{ 0 };    // Ожиданий данных
+    __u64  _S_consumer_wait_ns{ 0 };  // Суммарное время ожидания данных
+    };
+//////////////////////////////////////////////////////////////////////
+  template <typename _Tp>
+  class pblocking_queue
+    {
+    private:
+      typedef std::chrono::steady_clock  _Clock;
+
+      pdeque<_Tp>              _M_items;
+      __u64                    _M_high_water;
+      pbackpressure            _M_policy;
+      bool                     _M_closed{ false };
+      __u32                    _M_waiting_producers{ 0 };
+      __u32                    _M_waiting_consumers{ 0 };
+      pqueue_stats             _M_stats;
+
+      mutable std::mutex       _M_mutex;
+      std::condition_variable  _M_not_empty;  // Появились данные или закрыта
+      std::condition_variable  _M_not_full;   // Появилось место или закрыта
+      std::condition_variable  _M_drained;    // Закрыта и пуста
+
+      static auto
+      elapsed_ns( _Clock::time_point __from ) -> __u64
+        {
+        return static_cast<__u64>( std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     _Clock::now() - __from ).count() );
+        }
+//--------------------------------------------------------------------
+      // Ожидание места под блокировкой; false - очередь закрыта.
+      auto
+      wait_space( std::unique_lock<std::mutex>& __lock ) -> bool
+        {
+        if( _M_items.size() >= _M_high_water && !_M_closed )
+          {
+          _Clock::time_point  __start = _Clock::now();
+
+          _M_waiting_producers++;
+          _M_not_full.wait( __lock, [&]
+            { return _M_closed || _M_items.size() < _M_high_water; } );
+          _M_waiting_producers--;
+
+          _M_stats._S_producer_waits++;
+          _M_stats._S_producer_wait_ns += elapsed_ns( __start );
+          }
+
+        return !_M_closed;
+        }
+//--------------------------------------------------------------------
+      // Ожидание данных под блокировкой не дольше __timeout.
+      // false - данных нет (тайм-аут или закрытая пустая очередь).
+      // Нулевой тайм-аут (try_pop()) - проверка без ожидания, в
+      // счетчики ожиданий не попадает.
+      template <typename _Rep, typename _Period>
+        auto
+        wait_items( std::unique_lock<std::mutex>& __lock,
+                    const std::chrono::duration<_Rep, _Period>& __timeout ) -> bool
+          {
+          if( __timeout <= __timeout.zero() )
+            { return !_M_items.is_empty(); }
+
+          if( _M_items.is_empty() && !_M_closed )
+            {
+            _Clock::time_point  __start = _Clock::now();
+
+            _M_waiting_consumers++;
+            _M_not_empty.wait_for( __lock, __timeout, [&]
+              { return _M_closed || !_M_items.is_empty(); } );
+            _M_waiting_consumers--;
+
+            _M_stats._S_consumer_waits++;
+            _M_stats._S_consumer_wait_ns += elapsed_ns( __start );
+            }
+
+          return !_M_items.is_empty();
+          }
+//--------------------------------------------------------------------
+      // Вставка под блокировкой и пробуждение потребителя.
+      template <typename _Up>
+        auto
+        put( std::unique_lock<std::mutex>& __lock, _Up&& __data ) -> void
+          {
+          _M_items.push_back( std::forward<_Up>( __data ) );
+          _M_stats._S_pushed++;
+          if( _M_items.size() > _M_stats._S_max_depth )
+            { _M_stats._S_max_depth = _M_items.size(); }
+
+          bool  __wake = _M_waiting_consumers > 0;
+          __lock.unlock();
+
+          if( __wake )
+            { _M_not_empty.notify_one(); }
+          }
+//--------------------------------------------------------------------
+      // Учет извлечения __n элементов и пробуждение производителей.
+      auto
+      taken( std::unique_lock<std::mutex>& __lock, __u64 __n ) -> void
+        {
+        _M_stats._S_popped += __n;
+
+        bool  __wake    = _M_waiting_producers > 0;
+        bool  __drained = _M_closed && _M_items.is_empty();
+        __lock.unlock();
+
+        if( __wake )
+          {
+          if( __n == 1 )
+            { _M_not_full.notify_one(); }
+          else
+            { _M_not_full.notify_all(); }
+          }
+
+        if( __drained )
+          { _M_drained.notify_all(); }
+        }
+//--------------------------------------------------------------------
+      template <typename _Up>
+        auto
+        push_impl( _Up&& __data ) -> bool
+          {
+          std::unique_lock<std::mutex>  __lock( _M_mutex );
+
+          bool  __ok = _M_policy == pbackpressure::block
+                       ? wait_space( __lock )
+                       : !_M_closed && _M_items.size() < _M_high_water;
+
+          if( !__ok )
+            {
+            _M_stats._S_rejected++;
+            return false;
+            }
+
+          put( __lock, std::forward<_Up>( __data ) );
+          return true;
+          }
+//--------------------------------------------------------------------
+      template <typename _Up>
+        auto
+        try_push_impl( _Up&& __data ) -> bool
+          {
+          std::unique_lock<std::mutex>  __lock( _M_mutex );
+
+          if( _M_closed || _M_items.size() >= _M_high_water )
+            {
+            _M_stats._S_rejected++;
+            return false;
+            }
+
+          put( __lock, std::forward<_Up>( __data ) );
+          return true;
+          }
+
+    public:
+      /** __high_water - наибольшее количество элементов в очереди.
+       */
+      explicit
+      pblocking_queue( __u64 __high_water = ~0ULL,
+                       pbackpressure __policy = pbackpressure::block )
+        : _M_high_water( __high_water ), _M_policy( __policy )
+        {
+        if( __high_water == 0 )
+          { throw pexception( "E: Недопустимая емкость очереди." ); }
+        }
+
+      pblocking_queue( const pblocking_queue& ) = delete;
+
+      pblocking_queue&
+      operator=( const pblocking_queue& ) = delete;
+
+      ~pblocking_queue() noexcept
+        { }
+//--------------------------------------------------------------------
+// Вставка элемента. При заполненной очереди - ожидание места или
+// отказ, в зависимости от политики. false - отказ или очередь
+// закрыта.
+      auto
+      push( const _Tp& __data ) -> bool
+        { return push_impl( __data ); }
+//--------------------------------------------------------------------
+      auto
+      push( _Tp&& __data ) -> bool
+        { return push_impl( std::move( __data ) ); }
+//--------------------------------------------------------------------
+// Вставка без ожидания при любой политике.
+      auto
+      try_push( const _Tp& __data ) -> bool
+        { return try_push_impl( __data ); }
+//--------------------------------------------------------------------
+      auto
+      try_push( _Tp&& __data ) -> bool
+        { return try_push_impl( std::move( __data ) ); }
+//--------------------------------------------------------------------
+// Извлечение с ожиданием не дольше __timeout.
+// false - тайм-аут или очередь закрыта и пуста.
+      template <typename _Rep, typename _Period>
+        auto
+        pop_wait( _Tp& __out,
+                  const std::chrono::duration<_Rep, _Period>& __timeout ) -> bool
+          {
+          std::unique_lock<std::mutex>  __lock( _M_mutex );
+
+          if( !wait_items( __lock, __timeout ) )
+            { return false; }
+
+          __out = _M_items.pop_front();
+          taken( __lock, 1 );
+          return true;
+          }
+//--------------------------------------------------------------------
+// Извлечение с ожиданием без тайм-аута.
+// false - очередь закрыта и пуста.
+      auto
+      pop_wait( _Tp& __out ) -> bool
+        {
+        while( !pop_wait( __out, std::chrono::hours( 24 ) ) )
+          {
+          if( is_closed() )
+            { return false; }
+          }
+        return true;
+        }
+//--------------------------------------------------------------------
+      auto
+      try_pop( _Tp& __out ) -> bool
+        { return pop_wait( __out, std::chrono::nanoseconds( 0 ) ); }
+//--------------------------------------------------------------------
+// Извлечение до __max_n элементов в конец __out за одну блокировку,
+// с ожиданием хотя бы одного не дольше __timeout. Возвращает
+// количество извлеченных; 0 - тайм-аут или очередь закрыта и пуста.
+      template <typename _Rep, typename _Period>
+        auto
+        pop_batch( std::vector<_Tp>& __out, __u64 __max_n,
+                   const std::chrono::duration<_Rep, _Period>& __timeout ) -> __u64
+          {
+          if( __max_n == 0 )
+            { return 0; }
+
+          std::unique_lock<std::mutex>  __lock( _M_mutex );
+
+          if( !wait_items( __lock, __timeout ) )
+            { return 0; }
+
+          __u64  __n = _M_items.size() < __max_n ? _M_items.size() : __max_n;
+          for( __u64 __i{ 0 }; __i < __n; __i++ )
+            { __out.push_back( _M_items.pop_front() ); }
+
+          taken( __lock, __n );
+          return __n;
+          }
+//--------------------------------------------------------------------
+// Извлечение до __max_n элементов с ожиданием без тайм-аута.
+// 0 - очередь закрыта и пуста.
+      auto
+      pop_batch( std::vector<_Tp>& __out, __u64 __max_n ) -> __u64
+        {
+        for( ;; )
+          {
+          __u64  __n = pop_batch( __out, __max_n, std::chrono::hours( 24 ) );
+          if( __n != 0 || __max_n == 0 || is_closed() )
+            { return __n; }
+          }
+        }
+//--------------------------------------------------------------------
+// Закрытие очереди: новые элементы не принимаются, ждущие потоки
+// просыпаются. Оставшиеся элементы можно извлечь.
+      auto
+      close() -> void
+        {
+        bool  __drained;
+
+          {
+          std::lock_guard<std::mutex>  __lock( _M_mutex );
+          _M_closed = true;
+          __drained = _M_items.is_empty();
+          }
+
+        _M_not_empty.notify_all();
+        _M_not_full.notify_all();
+        if( __drained )
+          { _M_drained.notify_all(); }
+        }
+//--------------------------------------------------------------------
+// Ожидание, пока очередь не будет закрыта и опустошена.
+      auto
+      wait_drained() -> void
+        {
+        std::unique_lock<std::mutex>  __lock( _M_mutex );
+        _M_drained.wait( __lock, [&] { return _M_closed && _M_items.is_empty(); } );
+        }
+//--------------------------------------------------------------------
+      auto
+      is_closed() const -> bool
+        {
+        std::lock_guard<std::mutex>  __lock( _M_mutex );
+        return _M_closed;
+        }
+//--------------------------------------------------------------------
+      auto
+      is_drained() const -> bool
+        {
+        std::lock_guard<std::mutex>  __lock( _M_mutex );
+        return _M_closed && _M_items.is_empty();
+        }
+//--------------------------------------------------------------------
+      auto
+      depth() const -> __u64
+        {
+        std::lock_guard<std::mutex>  __lock( _M_mutex );
+        return _M_items.size();
+        }
+//--------------------------------------------------------------------
+      auto
+      high_water() const -> __u64
+        { return _M_high_water; }
+//--------------------------------------------------------------------
+// Снимок счетчиков.
+      auto
+      stats() const -> pqueue_stats
+        {
+        std::lock_guard<std::mutex>  __lock( _M_mutex );
+        pqueue_stats  __s = _M_stats;
+        __s._S_depth = _M_items.size();
+        return __s;
+        }
+
+    }; // class pblocking_queue
+
+  } // namespace ptl
+
+#endif // __PTL_PBLOCKING_QUEUE_H__
@@ -0,0 +1,699 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для B+-дерева.
+ */
+
+/**
+ *  (PTL) Patriarch library : pbplus_tree.h
+ */
+
+#pragma once
+#if !defined( __PTL_PBPLUS_TREE_H__ )
+#define __PTL_PBPLUS_TREE_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#if !defined( __PTL_PEXCEPT_H__ )
+#include "pexcept.h"
+#endif
+
+#if !defined( __PTL_PPARALLEL_H__ )
+#include "pparallel.h"
+#endif
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+/*
+ * B+-дерево - упорядоченный словарь для поиска в памяти. Узел
+ * хранит до _Fanout ключей подряд, поэтому высота дерева -
+ * log_{_Fanout} n, и поиск читает несколько соседних строк кэша на
+ * уровень вместо одного случайного узла на каждое сравнение, как в
+ * бинарном дереве. Пары лежат только в листьях, листья связаны в
+ * список по возрастанию ключей для обхода диапазонов.
+ *
+ * Поиск внутри узла - двоичный без ветвлений: шаг выбирается
+ * условной пересылкой, а не переходом, поэтому предсказатель
+ * переходов не ошибается на случайных ключах. Перед поиском все
+ * строки кэша с ключами узла запрашиваются разом, и промахи по ним
+ * ожидаются одновременно, а не по одному на шаг поиска.
+ *
+ * Узлы, кроме корня, заполнены не меньше чем наполовину: при вставке
+ * полный узел делится пополам, при удалении недозаполненный узел
+ * занимает пару у соседа или сливается с ним.
+ *
+ * Ключи и значения хранятся в массивах узла, поэтому должны иметь
+ * конструктор по умолчанию и присваивание. _Fanout - четное, не
+ * меньше 4; по умолчанию ключи внутреннего узла занимают около 8
+ * строк кэша.
+ *
+ * Методы:
+ *   - insert() - вставка пары, если ключа еще нет
+ *   - erase() - удаление по ключу
+ *   - find() - поиск значения по ключу
+ *   - contains() - проверка наличия ключа
+ *   - range() - обход пар с ключами из [lo, hi) по возрастанию
+ *   - bulk_load() - построение из отсортированных пар за O(n)
+ *   - size(), empty(), height(), clear()
+ *
+ * @code
+ *   ptl::pbplus_tree<ptl::__u64, ptl::__u32> index;
+ *   index.bulk_load( sorted.begin(), sorted.end() );
+ *   if( ptl::__u32* v = index.find( key ) ) { ... }
+ *   index.range( lo, hi, []( ptl::__u64 k, ptl::__u32 v ) { ... } );
+ * @endcode
+ */
+
+namespace ptl
+  {
+  namespace __detail
+    {
+    // Ширина узла по умолчанию: ключи внутреннего узла занимают
+    // около 8 строк кэша, но не меньше 8 и не больше 256 ключей.
+    template <typename _Key>
+      constexpr auto
+      bplus_fanout() -> __u32
+        {
+        __u32  __n = 8 * cache_line_size / sizeof( _Key );
+        __n = __n < 8 ? 8 : ( __n > 256 ? 256 : __n );
+        return __n & ~1u;
+        }
+    } // namespace __detail
+//////////////////////////////////////////////////////////////////////
+  template <typename _Key, typename _Val, typename _Compare = std::less<_Key>,
+            __u32 _Fanout = __detail::bplus_fanout<_Key>()>
+  class pbplus_tree
+    {
+      static_assert( _Fanout >= 4 && _Fanout % 2 == 0,
+                     "Ширина узла должна быть четной и не меньше 4." );
+
+    private:
+      // Лист - до _Fanout пар; внутренний узел - до _Fanout - 1
+      // ключей и _Fanout детей. Массивы на одну ячейку больше, чтобы
+      // переполненный узел можно было сначала дополнить, а потом
+      // разделить.
+      static constexpr __u32  __leaf_max  = _Fanout;
+      static constexpr __u32  __leaf_min  = _Fanout / 2;
+      static constexpr __u32  __inner_max = _Fanout - 1;
+      static constexpr __u32  __inner_min = _Fanout / 2 - 1;
+
+      struct alignas( cache_line_size ) _Node
+        {
+        __u32  _S_count{ 0 };  // ключей в узле
+        bool   _S_leaf;
+
+        explicit
+        _Node( bool __leaf )
+          : _S_leaf( __leaf )
+          { }
+        };
+
+      struct _Leaf : _Node
+        {
+        _Key    _S_keys[__leaf_max + 1];
+        _Val    _S_vals[__leaf_max + 1];
+        _Leaf*  _S_next{ nullptr };
+
+        _Leaf()
+          : _Node( true )
+          { }
+        };
+
+      struct _Inner : _Node
+        {
+        _Key    _S_keys[__inner_max + 1];
+        _Node*  _S_child[__inner_max + 2];
+
+        _Inner()
+          : _Node( false )
+          { }
+        };
+
+      _Node*    _M_root{ nullptr };
+      __u64     _M_size{ 0 };
+      __u32     _M_height{ 0 };
+      _Compare  _M_less;
+
+//--------------------------------------------------------------------
+      static auto
+      leaf( _Node* __n ) -> _Leaf*
+        { return static_cast<_Leaf*>( __n ); }
+//--------------------------------------------------------------------
+      static auto
+      inner( _Node* __n ) -> _Inner*
+        { return static_cast<_Inner*>( __n ); }
+//--------------------------------------------------------------------
+      // Количество ключей __keys[0, __n), для которых __before( k )
+      // истинно; ключи упорядочены так, что такие идут первыми.
+      // Двоичный поиск без ветвлений: сдвиг базы - условная пересылка.
+      template <typename _Pred>
+        static auto
+        partition_point( const _Key* __keys, __u32 __n, _Pred __before ) -> __u32
+          {
+          if( __n == 0 )
+            { return 0; }
+
+          const _Key*  __base = __keys;
+          while( __n > 1 )
+            {
+            __u32  __half = __n / 2;
+            __base = __before( __base[__half] ) ? __base + __half : __base;
+            __n -= __half;
+            }
+
+          return static_cast<__u32>( __base - __keys ) + ( __before( *__base ) ? 1 : 0 );
+          }
+//--------------------------------------------------------------------
+      // Позиция первого ключа, не меньшего __key.
+      auto
+      lower( const _Key* __keys, __u32 __n, const _Key& __key ) const -> __u32
+        {
+        return partition_point( __keys, __n, [&]( const _Key& __k )
+          { return _M_less( __k, __key ); } );
+        }
+//--------------------------------------------------------------------
+      // Номер ребенка внутреннего узла, в поддереве которого __key:
+      // количество разделителей, не больших __key.
+      auto
+      route( const _Inner* __n, const _Key& __key ) const -> __u32
+        {
+        return partition_point( __n->_S_keys, __n->_S_count, [&]( const _Key& __k )
+          { return !_M_less( __key, __k ); } );
+        }
+//--------------------------------------------------------------------
+      // Запрос всех строк кэша с ключами узла до поиска в нем (при
+      // поиске, вставке и удалении): шаги двоичного поиска зависят
+      // друг от друга, и без этого каждый промах по строке ждал бы
+      // предыдущего.
+      static auto
+      prefetch_keys( const _Key* __keys, __u32 __n ) -> void
+        {
+        const char*  __p   = reinterpret_cast<const char*>( __keys );
+        const char*  __end = reinterpret_cast<const char*>( __keys + __n );
+        for( ; __p < __end; __p += cache_line_size )
+          { __builtin_prefetch( __p ); }
+        }
+//--------------------------------------------------------------------
+      // Лист, в котором должен лежать __key.
+      auto
+      find_leaf( const _Key& __key ) const -> _Leaf*
+        {
+        _Node*  __n = _M_root;
+        while( !__n->_S_leaf )
+          {
+          prefetch_keys( inner( __n )->_S_keys, __n->_S_count );
+          __n = inner( __n )->_S_child[route( inner( __n ), __key )];
+          }
+        prefetch_keys( leaf( __n )->_S_keys, __n->_S_count );
+        return leaf( __n );
+        }
+//--------------------------------------------------------------------
+      // Вставка в поддерево __n. Если узел разделился, в __split
+      // возвращается новый правый узел, в __sep - его наименьший ключ.
+      auto
+      insert_rec( _Node* __n, const _Key& __key, const _Val& __val,
+                  _Node*& __split, _Key& __sep ) -> bool
+        {
+        __split = nullptr;
+
+        if( __n->_S_leaf )
+          {
+          _Leaf*  __l = leaf( __n );
+          prefetch_keys( __l->_S_keys, __l->_S_count );
+          __u32   __pos = lower( __l->_S_keys, __l->_S_count, __key );
+
+          if( __pos < __l->_S_count && !_M_less( __key, __l->_S_keys[__pos] ) )
+            { return false; }
+
+          for( __u32 __i = __l->_S_count; __i > __pos; __i-- )
+            {
+            __l->_S_keys[__i] = std::move( __l->_S_keys[__i - 1] );
+            __l->_S_vals[__i] = std::move( __l->_S_vals[__i - 1] );
+            }
+          __l->_S_keys[__pos] = __key;
+          __l->_S_vals[__pos] = __val;
+          __l->_S_count++;
+
+          if( __l->_S_count > __leaf_max )
+            {
+            _Leaf*  __r    = new _Leaf;
+            __u32   __keep = __l->_S_count / 2;
+
+            for( __u32 __i = __keep; __i < __l->_S_count; __i++ )
+              {
+              __r->_S_keys[__i - __keep] = std::move( __l->_S_keys[__i] );
+              __r->_S_vals[__i - __keep] = std::move( __l->_S_vals[__i] );
+              }
+            __r->_S_count = __l->_S_count - __keep;
+            __l->_S_count = __keep;
+            __r->_S_next  = __l->_S_next;
+            __l->_S_next  = __r;
+
+            __split = __r;
+            __sep   = __r->_S_keys[0];
+            }
+          return true;
+          }
+
+        _Inner*  __in = inner( __n );
+        prefetch_keys( __in->_S_keys, __in->_S_count );
+        __u32    __pos = route( __in, __key );
+        _Node*   __child_split;
+        _Key     __child_sep;
+
+        if( !insert_rec( __in->_S_child[__pos], __key, __val, __child_split, __child_sep ) )
+          { return false; }
+
+        if( __child_split == nullptr )
+          { return true; }
+
+        for( __u32 __i = __in->_S_count; __i > __pos; __i-- )
+          {
+          __in->_S_keys[__i]      = std::move( __in->_S_keys[__i - 1] );
+          __in->_S_child[__i + 1] = __in->_S_child[__i];
+          }
+        __in->_S_keys[__pos]      = std::move( __child_sep );
+        __in->_S_child[__pos + 1] = __child_split;
+        __in->_S_count++;
+
+        if( __in->_S_count > __inner_max )
+          {
+          /** Средний ключ поднимается к родителю и из узлов уходит.
+           */
+          _Inner*  __r   = new _Inner;
+          __u32    __mid = __in->_S_count / 2;
+
+          for( __u32 __i = __mid + 1; __i < __in->_S_count; __i++ )
+            { __r->_S_keys[__i - __mid - 1] = std::move( __in->_S_keys[__i] ); }
+          for( __u32 __i = __mid + 1; __i <= __in->_S_count; __i++ )
+            { __r->_S_child[__i - __mid - 1] = __in->_S_child[__i]; }
+
+          __r->_S_count  = __in->_S_count - __mid - 1;
+          __in->_S_count = __mid;
+
+          __split = __r;
+          __sep   = std::move( __in->_S_keys[__mid] );
+          }
+        return true;
+        }
+//--------------------------------------------------------------------
+      // Восстановление заполненности ребенка __i узла __p: заем пары
+      // у соседа или слияние с ним.
+      auto
+      fix_child( _Inner* __p, __u32 __i ) -> void
+        {
+        _Node*  __c = __p->_S_child[__i];
+        _Node*  __left  = __i > 0 ? __p->_S_child[__i - 1] : nullptr;
+        _Node*  __right = __i < __p->_S_count ? __p->_S_child[__i + 1] : nullptr;
+        __u32   __min   = __c->_S_leaf ? __leaf_min : __inner_min;
+
+        if( __left != nullptr && __left->_S_count > __min )
+          {
+          if( __c->_S_leaf )
+            {
+            _Leaf*  __l = leaf( __left );
+            _Leaf*  __x = leaf( __c );
+            for( __u32 __k = __x->_S_count; __k > 0; __k-- )
+              {
+              __x->_S_keys[__k] = std::move( __x->_S_keys[__k - 1] );
+              __x->_S_vals[__k] = std::move( __x->_S_vals[__k - 1] );
+              }
+            __l->_S_count--;
+            __x->_S_keys[0] = std::move( __l->_S_keys[__l->_S_count] );
+            __x->_S_vals[0] = std::move( __l->_S_vals[__l->_S_count] );
+            __x->_S_count++;
+            __p->_S_keys[__i - 1] = __x->_S_keys[0];
+            }
+          else
+            {
+            _Inner*  __l = inner( __left );
+            _Inner*  __x = inner( __c );
+            for( __u32 __k = __x->_S_count; __k > 0; __k-- )
+              { __x->_S_keys[__k] = std::move( __x->_S_keys[__k - 1] ); }
+            for( __u32 __k = __x->_S_count + 1; __k > 0; __k-- )
+              { __x->_S_child[__k] = __x->_S_child[__k - 1]; }
+            __x->_S_keys[0]  = std::move( __p->_S_keys[__i - 1] );
+            __x->_S_child[0] = __l->_S_child[__l->_S_count];
+            __x->_S_count++;
+            __l->_S_count--;
+            __p->_S_keys[__i - 1] = std::move( __l->_S_keys[__l->_S_count] );
+            }
+          return;
+          }
+
+        if( __right != nullptr && __right->_S_count > __min )
+          {
+          if( __c->_S_leaf )
+            {
+            _Leaf*  __r = leaf( __right );
+            _Leaf*  __x = leaf( __c );
+            __x->_S_keys[__x->_S_count] = std::move( __r->_S_keys[0] );
+            __x->_S_vals[__x->_S_count] = std::move( __r->_S_vals[0] );
+            __x->_S_count++;
+            __r->_S_count--;
+            for( __u32 __k{ 0 }; __k < __r->_S_count; __k++ )
+              {
+              __r->_S_keys[__k] = std::move( __r->_S_keys[__k + 1] );
+              __r->_S_vals[__k] = std::move( __r->_S_vals[__k + 1] );
+              }
+            __p->_S_keys[__i] = __r->_S_keys[0];
+            }
+          else
+            {
+            _Inner*  __r = inner( __right );
+            _Inner*  __x = inner( __c );
+            __x->_S_keys[__x->_S_count]      = std::move( __p->_S_keys[__i] );
+            __x->_S_child[__x->_S_count + 1] = __r->_S_child[0];
+            __x->_S_count++;
+            __p->_S_keys[__i] = std::move( __r->_S_keys[0] );
+            for( __u32 __k{ 0 }; __k + 1 < __r->_S_count; __k++ )
+              { __r->_S_keys[__k] = std::move( __r->_S_keys[__k + 1] ); }
+            for( __u32 __k{ 0 }; __k < __r->_S_count; __k++ )
+              { __r->_S_child[__k] = __r->_S_child[__k + 1]; }
+            __r->_S_count--;
+            }
+          return;
+          }
+
+        /** Заем невозможен: сливаем ребенка __j + 1 в ребенка __j.
+         */
+        __u32   __j = __left != nullptr ? __i - 1 : __i;
+        _Node*  __a = __p->_S_child[__j];
+        _Node*  __b = __p->_S_child[__j + 1];
+
+        if( __a->_S_leaf )
+          {
+          _Leaf*  __l = leaf( __a );
+          _Leaf*  __r = leaf( __b );
+          for( __u32 __k{ 0 }; __k < __r->_S_count; __k++ )
+            {
+            __l->_S_keys[__l->_S_count + __k] = std::move( __r->_S_keys[__k] );
+            __l->_S_vals[__l->_S_count + __k] = std::move( __r->_S_vals[__k] );
+            }
+          __l->_S_count += __r->_S_count;
+          __l->_S_next   = __r->_S_next;
+          delete __r;
+          }
+        else
+          {
+          _Inner*  __l = inner( __a );
+          _Inner*  __r = inner( __b );
+          __l->_S_keys[__l->_S_count] = std::move( __p->_S_keys[__j] );
+          for( __u32 __k{ 0 }; __k < __r->_S_count; __k++ )
+            { __l->_S_keys[__l->_S_count + 1 + __k] = std::move( __r->_S_keys[__k] ); }
+          for( __u32 __k{ 0 }; __k <= __r->_S_count; __k++ )
+            { __l->_S_child[__l->_S_count + 1 + __k] = __r->_S_child[__k]; }
+          __l->_S_count += __r->_S_count + 1;
+          delete __r;
+          }
+
+        for( __u32 __k = __j; __k + 1 < __p->_S_count; __k++ )
+          { __p->_S_keys[__k] = std::move( __p->_S_keys[__k + 1] ); }
+        for( __u32 __k = __j + 1; __k < __p->_S_count; __k++ )
+          { __p->_S_child[__k] = __p->_S_child[__k + 1]; }
+        __p->_S_count--;
+        }
+//--------------------------------------------------------------------
+      // Удаление __key из поддерева __n.
+      auto
+      erase_rec( _Node* __n, const _Key& __key ) -> bool
+        {
+        if( __n->_S_leaf )
+          {
+          _Leaf*  __l = leaf( __n );
+          prefetch_keys( __l->_S_keys, __l->_S_count );
+          __u32   __pos = lower( __l->_S_keys, __l->_S_count, __key );
+
+          if( __pos == __l->_S_count || _M_less( __key, __l->_S_keys[__pos] ) )
+            { return false; }
+
+          for( __u32 __k = __pos; __k + 1 < __l->_S_count; __k++ )
+            {
+            __l->_S_keys[__k] = std::move( __l->_S_keys[__k + 1] );
+            __l->_S_vals[__k] = std::move( __l->_S_vals[__k + 1] );
+            }
+          __l->_S_count--;
+          return true;
+          }
+
+        _Inner*  __in = inner( __n );
+        prefetch_keys( __in->_S_keys, __in->_S_count );
+        __u32    __pos = route( __in, __key );
+
+        if( !erase_rec( __in->_S_child[__pos], __key ) )
+          { return false; }
+
+        _Node*  __c = __in->_S_child[__pos];
+        if( __c->_S_count < ( __c->_S_leaf ? __leaf_min : __inner_min ) )
+          { fix_child( __in, __pos ); }
+        return true;
+        }
+//--------------------------------------------------------------------
+      static auto
+      destroy( _Node* __n ) -> void
+        {
+        if( !__n->_S_leaf )
+          {
+          for( __u32 __i{ 0 }; __i <= __n->_S_count; __i++ )
+            { destroy( inner( __n )->_S_child[__i] ); }
+          delete inner( __n );
+          }
+        else
+          { delete leaf( __n ); }
+        }
+
+    public:
+      explicit
+      pbplus_tree( const _Compare& __less = _Compare() )
+        : _M_less( __less )
+        { }
+
+      pbplus_tree( const pbplus_tree& ) = delete;
+
+      pbplus_tree&
+      operator=( const pbplus_tree& ) = delete;
+
+      ~pbplus_tree() noexcept
+        { clear(); }
+//--------------------------------------------------------------------
+// Вставка пары, если ключа __key еще нет. false - ключ уже есть.
+      auto
+      insert( const _Key& __key, const _Val& __val ) -> bool
+        {
+        if( _M_root == nullptr )
+          {
+          _M_root   = new _Leaf;
+          _M_height = 1;
+          }
+
+        _Node*  __split;
+        _Key    __sep;
+
+        if( !insert_rec( _M_root, __key, __val, __split, __sep ) )
+          { return false; }
+
+        if( __split != nullptr )
+          {
+          _Inner*  __root = new _Inner;
+          __root->_S_keys[0]  = std::move( __sep );
+          __root->_S_child[0] = _M_root;
+          __root->_S_child[1] = __split;
+          __root->_S_count    = 1;
+          _M_root = __root;
+          _M_height++;
+          }
+
+        _M_size++;
+        return true;
+        }
+//--------------------------------------------------------------------
+// Удаление пары по ключу. false - ключа нет.
+      auto
+      erase( const _Key& __key ) -> bool
+        {
+        if( _M_root == nullptr || !erase_rec( _M_root, __key ) )
+          { return false; }
+
+        _M_size--;
+
+        /** Корень без ключей заменяется единственным ребенком.
+         */
+        if( !_M_root->_S_leaf && _M_root->_S_count == 0 )
+          {
+          _Node*  __old = _M_root;
+          _M_root = inner( __old )->_S_child[0];
+          delete inner( __old );
+          _M_height--;
+          }
+        else if( _M_root->_S_leaf && _M_root->_S_count == 0 )
+          { clear(); }
+
+        return true;
+        }
+//--------------------------------------------------------------------
+// Указатель на значение по ключу или nullptr.
+      auto
+      find( const _Key& __key ) -> _Val*
+        {
+        if( _M_root == nullptr )
+          { return nullptr; }
+
+        _Leaf*  __l   = find_leaf( __key );
+        __u32   __pos = lower( __l->_S_keys, __l->_S_count, __key );
+
+        if( __pos == __l->_S_count || _M_less( __key, __l->_S_keys[__pos] ) )
+          { return nullptr; }
+        return &__l->_S_vals[__pos];
+        }
+//--------------------------------------------------------------------
+      auto
+      contains( const _Key& __key ) const -> bool
+        { return const_cast<pbplus_tree*>( this )->find( __key ) != nullptr; }
+//--------------------------------------------------------------------
+// Вызов __f( key, value ) для пар с ключами из [__lo, __hi) по
+// возрастанию: спуск к первому листу и проход по списку листьев.
+      template <typename _Func>
+        auto
+        range( const _Key& __lo, const _Key& __hi, _Func __f ) const -> void
+          {
+          if( _M_root == nullptr )
+            { return; }
+
+          _Leaf*  __l   = find_leaf( __lo );
+          __u32   __pos = lower( __l->_S_keys, __l->_S_count, __lo );
+
+          for( ; __l != nullptr; __l = __l->_S_next, __pos = 0 )
+            {
+            for( ; __pos < __l->_S_count; __pos++ )
+              {
+              if( !_M_less( __l->_S_keys[__pos], __hi ) )
+                { return; }
+              __f( static_cast<const _Key&>( __l->_S_keys[__pos] ),
+                   static_cast<const _Val&>( __l->_S_vals[__pos] ) );
+              }
+            }
+          }
+//--------------------------------------------------------------------
+// Построение дерева из пар [__first, __last), отсортированных по
+// ключу строго по возрастанию (у элемента есть first и second).
+// Прежнее содержимое удаляется. Листья заполняются полностью, а
+// остаток распределяется поровну, поэтому каждый узел заполнен не
+// меньше чем наполовину.
+      template <typename _Iter>
+        auto
+        bulk_load( _Iter __first, _Iter __last ) -> void
+          {
+          clear();
+
+          std::vector<std::pair<_Key, _Val>>  __items;
+          for( ; __first != __last; ++__first )
+            {
+            if( !__items.empty() && !_M_less( __items.back().first, __first->first ) )
+              { throw pexception( "E: Пары для bulk_load() не упорядочены строго по возрастанию." ); }
+            __items.emplace_back( __first->first, __first->second );
+            }
+
+          if( __items.empty() )
+            { return; }
+
+          /** Уровень - узлы и наименьшие ключи их поддеревьев.
+           */
+          std::vector<_Node*>  __level;
+          std::vector<_Key>    __low;
+
+          __u64  __n      = __items.size();
+          __u64  __leaves = ( __n + __leaf_max - 1 ) / __leaf_max;
+          __u64  __at{ 0 };
+          _Leaf* __prev{ nullptr };
+
+          for( __u64 __i{ 0 }; __i < __leaves; __i++ )
+            {
+            __u64   __take = __n / __leaves + ( __i < __n % __leaves ? 1 : 0 );
+            _Leaf*  __l    = new _Leaf;
+
+            for( __u64 __k{ 0 }; __k < __take; __k++, __at++ )
+              {
+              __l->_S_keys[__k] = std::move( __items[__at].first );
+              __l->_S_vals[__k] = std::move( __items[__at].second );
+              }
+            __l->_S_count = static_cast<__u32>( __take );
+
+            if( __prev != nullptr )
+              { __prev->_S_next = __l; }
+            __prev = __l;
+
+            __level.push_back( __l );
+            __low.push_back( __l->_S_keys[0] );
+            }
+
+          _M_height = 1;
+
+          while( __level.size() > 1 )
+            {
+            std::vector<_Node*>  __up;
+            std::vector<_Key>    __up_low;
+
+            __u64  __m     = __level.size();
+            __u64  __nodes = ( __m + __inner_max ) / ( __inner_max + 1 );
+            __at = 0;
+
+            for( __u64 __i{ 0 }; __i < __nodes; __i++ )
+              {
+              __u64    __take = __m / __nodes + ( __i < __m % __nodes ? 1 : 0 );
+              _Inner*  __in   = new _Inner;
+
+              for( __u64 __k{ 0 }; __k < __take; __k++, __at++ )
+                {
+                __in->_S_child[__k] = __level[__at];
+                if( __k > 0 )
+                  { __in->_S_keys[__k - 1] = __low[__at]; }
+                }
+              __in->_S_count = static_cast<__u32>( __take - 1 );
+
+              __up.push_back( __in );
+              __up_low.push_back( __low[__at - __take] );
+              }
+
+            __level.swap( __up );
+            __low.swap( __up_low );
+            _M_height++;
+            }
+
+          _M_root = __level[0];
+          _M_size = __n;
+          }
+//--------------------------------------------------------------------
+      auto
+      size() const -> __u64
+        { return _M_size; }
+//--------------------------------------------------------------------
+      auto
+      empty() const -> bool
+        { return _M_size == 0; }
+//--------------------------------------------------------------------
+// Количество уровней (0 - пустое дерево).
+      auto
+      height() const -> __u32
+        { return _M_height; }
+//--------------------------------------------------------------------
+      auto
+      clear() -> void
+        {
+        if( _M_root != nullptr )
+          { destroy( _M_root ); }
+        _M_root   = nullptr;
+        _M_size   = 0;
+        _M_height = 0;
+        }
+
+    }; // class pbplus_tree
+
+  } // namespace ptl
+
+#endif // __PTL_PBPLUS_TREE_H__
@@ -18,100 +18,417 @@
 #include "ptype.h"
 #endif
 
+#include <functional>
+#include <utility>
+
 /*
- * Бинарное дерево. 
+ * Бинарное дерево поиска, сбалансированное по высоте (АВЛ-дерево).
+ * Высоты поддеревьев любого узла отличаются не больше чем на 1,
+ * поэтому высота дерева - O(log n) при любом порядке вставки, в том
+ * числе отсортированном. Ключи уникальны и упорядочены по _Compare.
  *
  * Методы:
- *   - add_int() - добавление нового элемента
+ *   - insert() - добавление ключа (false - ключ уже есть)
+ *   - add_int() - добавление ключа, то же, что insert()
+ *   - contains() - проверка наличия ключа
+ *   - erase() - удаление ключа (false - ключа нет)
+ *   - lower_bound() - итератор на первый ключ, не меньший данного
+ *   - begin(), end() - итераторы обхода ключей по возрастанию
+ *   - size(), empty(), height(), clear()
+ *
+ * @code
+ *   ptl::pbtree<ptl::__s32> tree;
+ *   tree.insert( 5 );
+ *   tree.insert( 3 );
+ *   if( tree.contains( 3 ) ) { tree.erase( 3 ); }
+ *   for( auto it = tree.lower_bound( 4 ); it != tree.end(); ++it )
+ *     { std::cout << *it; }
+ * @endcode
  */
 
-#define SIZE 10
-
 namespace ptl
   {
 //////////////////////////////////////////////////////////////////////
+  template <typename _Key = __s32, typename _Compare = std::less<_Key>>
   class pbtree
     {
-    privet:
-      Node*  _M_root;         // корневой узел
-
-    public:
+    private:
       struct Node // структура узла бинарного дерева
         {
-        Node( __s32 _d, Node* _p = nullptr )
-          : _S_data( _d ),
-            _S_parent( _p )
+        Node( const _Key& _d, Node* _p )
+          : _S_parent( _p ),
+            _S_data( _d )
+          { }
+
+        Node*  _S_parent;                 // родительский узел
+
+        Node*  _S_leftChild{ nullptr };   // левый узел
+        Node*  _S_rightChild{ nullptr };  // правый узел
+
+        __s32  _S_height{ 1 };            // высота поддерева узла
+
+        _Key   _S_data;                   // данные узла
+
+        }; // struct Node
+
+      Node*     _M_root{ nullptr };       // корневой узел
+      __u64     _M_size{ 0 };
+      _Compare  _M_less;
+
+//--------------------------------------------------------------------
+      static auto
+      height( const Node* _n ) -> __s32
+        { return _n == nullptr ? 0 : _n->_S_height; }
+//--------------------------------------------------------------------
+      static auto
+      update( Node* _n ) -> void
+        {
+        __s32  _l = height( _n->_S_leftChild );
+        __s32  _r = height( _n->_S_rightChild );
+        _n->_S_height = ( _l > _r ? _l : _r ) + 1;
+        }
+//--------------------------------------------------------------------
+      static auto
+      leftmost( Node* _n ) -> Node*
+        {
+        while( _n->_S_leftChild != nullptr )
+          { _n = _n->_S_leftChild; }
+        return _n;
+        }
+//--------------------------------------------------------------------
+      // Замена ребенка _old узла _parent (или корня) на _new.
+      auto
+      replace_child( Node* _parent, Node* _old, Node* _new ) -> void
+        {
+        if( _parent == nullptr )
+          { _M_root = _new; }
+        else if( _parent->_S_leftChild == _old )
+          { _parent->_S_leftChild = _new; }
+        else
+          { _parent->_S_rightChild = _new; }
+
+        if( _new != nullptr )
+          { _new->_S_parent = _parent; }
+        }
+//--------------------------------------------------------------------
+      // Левый поворот вокруг _x; возвращает новый корень поддерева.
+      auto
+      rotate_left( Node* _x ) -> Node*
+        {
+        Node*  _y = _x->_S_rightChild;
+
+        replace_child( _x->_S_parent, _x, _y );
+
+        _x->_S_rightChild = _y->_S_leftChild;
+        if( _x->_S_rightChild != nullptr )
+          { _x->_S_rightChild->_S_parent = _x; }
+
+        _y->_S_leftChild = _x;
+        _x->_S_parent    = _y;
+
+        update( _x );
+        update( _y );
+        return _y;
+        }
+//--------------------------------------------------------------------
+      // Правый поворот вокруг _x; возвращает новый корень поддерева.
+      auto
+      rotate_right( Node* _x ) -> Node*
+        {
+        Node*  _y = _x->_S_leftChild;
+
+        replace_child( _x->_S_parent, _x, _y );
+
+        _x->_S_leftChild = _y->_S_rightChild;
+        if( _x->_S_leftChild != nullptr )
+          { _x->_S_leftChild->_S_parent = _x; }
+
+        _y->_S_rightChild = _x;
+        _x->_S_parent     = _y;
+
+        update( _x );
+        update( _y );
+        return _y;
+        }
+//--------------------------------------------------------------------
+      // Восстановление баланса узла _n одним или двумя поворотами.
+      // Возвращает корень поддерева на месте _n.
+      auto
+      rebalance( Node* _n ) -> Node*
+        {
+        update( _n );
+
+        __s32  _balance = height( _n->_S_leftChild ) - height( _n->_S_rightChild );
+
+        if( _balance > 1 )
           {
-          _S_leftChild  = nullptr;
-          _S_rightChild = nullptr;
+          if( height( _n->_S_leftChild->_S_leftChild )
+              < height( _n->_S_leftChild->_S_rightChild ) )
+            { rotate_left( _n->_S_leftChild ); }
+          return rotate_right( _n );
           }
 
-        ~Node()
+        if( _balance < -1 )
           {
-          if( _S_rightChild != nullptr )
-            { delete _S_rightChild; }
-          if( _S_leftChild != nullptr )
-            { delete _S_leftChild; }
+          if( height( _n->_S_rightChild->_S_rightChild )
+              < height( _n->_S_rightChild->_S_leftChild ) )
+            { rotate_right( _n->_S_rightChild ); }
+          return rotate_left( _n );
           }
 
-        Node*  _S_parent;     // родительский узел
+        return _n;
+        }
+//--------------------------------------------------------------------
+      // Подъем от родителя вставленного узла к корню с восстановлением
+      // высот. Останавливается, когда высота поддерева не изменилась
+      // или после поворота: поворот при вставке возвращает поддереву
+      // прежнюю высоту.
+      auto
+      retrace_insert( Node* _n ) -> void
+        {
+        while( _n != nullptr )
+          {
+          __s32  _before = _n->_S_height;
+          Node*  _top    = rebalance( _n );
 
-        Node*  _S_leftChild;  // левый узел
-        Node*  _S_rightChild; // правый узел
+          if( _top != _n || _top->_S_height == _before )
+            { break; }
+          _n = _n->_S_parent;
+          }
+        }
+//--------------------------------------------------------------------
+      // Первый узел с ключом, не меньшим _key, или nullptr.
+      auto
+      lower_node( const _Key& _key ) const -> Node*
+        {
+        Node*  _current = _M_root;
+        Node*  _found   = nullptr;
 
-        __s32  _S_data;       // данные узла
+        while( _current != nullptr )
+          {
+          if( _M_less( _current->_S_data, _key ) )
+            { _current = _current->_S_rightChild; }
+          else
+            {
+            _found   = _current;
+            _current = _current->_S_leftChild;
+            }
+          }
 
-        }; // struct Node
-      
-      pbtree()
-        { _M_root = nullptr; }
+        return _found;
+        }
 
-      ~pbtree() noexcept
+    public:
+      /*
+       * Итератор обхода ключей по возрастанию (ключи не изменяются).
+       */
+      class iterator
         {
-        if( _M_root != nullptr )
-          { delete _M_root; }
-        }
+        private:
+          Node*  _M_node;
+
+        public:
+          explicit
+          iterator( Node* _n = nullptr )
+            : _M_node( _n )
+            { }
+
+          auto
+          operator*() const -> const _Key&
+            { return _M_node->_S_data; }
+
+          auto
+          operator->() const -> const _Key*
+            { return &_M_node->_S_data; }
+
+          auto
+          operator++() -> iterator&
+            {
+            if( _M_node->_S_rightChild != nullptr )
+              { _M_node = leftmost( _M_node->_S_rightChild ); }
+            else
+              {
+              Node*  _from = _M_node;
+              _M_node = _M_node->_S_parent;
+              while( _M_node != nullptr && _from == _M_node->_S_rightChild )
+                {
+                _from   = _M_node;
+                _M_node = _M_node->_S_parent;
+                }
+              }
+            return *this;
+            }
+
+          auto
+          operator==( const iterator& _other ) const -> bool
+            { return _M_node == _other._M_node; }
+
+          auto
+          operator!=( const iterator& _other ) const -> bool
+            { return _M_node != _other._M_node; }
+        };
+
+      explicit
+      pbtree( const _Compare& _less = _Compare() )
+        : _M_less( _less )
+        { }
+
+      pbtree( const pbtree& ) = delete;
+
+      pbtree&
+      operator=( const pbtree& ) = delete;
+
+      ~pbtree() noexcept
+        { clear(); }
 //--------------------------------------------------------------------
-// Добавление нового элемента.
+// Добавление нового элемента. false - такой ключ уже есть.
       auto
-      add_int(  __s32 _newData ) -> void
+      insert( const _Key& _newData ) -> bool
         {
         if( _M_root == nullptr )
           // если дерево пустое, то новый элемент станет корнем
-          { _M_root = new Node( _newData ); }
-        else
           {
-          Node*  _current = _M_root; // начинаем с корня
-          Node*  _newNode = nullptr;
+          _M_root = new Node( _newData, nullptr );
+          _M_size = 1;
+          return true;
+          }
+
+        Node*  _current = _M_root; // начинаем с корня
 
-          while( _newNode == nullptr )
+        for( ;; )
+          {
+          if( _M_less( _newData, _current->_S_data ) )
+            // если элемент меньше текущего, идем влево
             {
-            if( _current->_S_data >= _newData )
-              // если элемент меньше текущего, идем влево
+            if( _current->_S_leftChild == nullptr )
               {
-              if( _current->_S_leftChild != nullptr )
-                {
-                _current = _current->_S_leftChild;
-                continue;
-                }
               // если левого узла нет, то нашли место для нового элемента
-              _newNode = new Node( _newData, _current );
-              _current->_S_leftChild = _newNode;
+              _current->_S_leftChild = new Node( _newData, _current );
+              break;
               }
-            else
-              // если елемент меньше текущего, идем вправо
+            _current = _current->_S_leftChild;
+            }
+          else if( _M_less( _current->_S_data, _newData ) )
+            // если элемент больше текущего, идем вправо
+            {
+            if( _current->_S_rightChild == nullptr )
               {
-              if( _current->_S_rightChild != nullptr )
-                {
-                _current = _current->_S_rightChild;
-                continue;
-                }
               // если правого узла нет, то нашли место для нового элемента
-              _newNode = new Node( _newData, _current );
-              _current->_S_rightChild = _newNode;
+              _current->_S_rightChild = new Node( _newData, _current );
+              break;
               }
+            _current = _current->_S_rightChild;
             }
-          }        
+          else
+            { return false; }
+          }
+
+        _M_size++;
+        retrace_insert( _current );
+        return true;
+        }
+//--------------------------------------------------------------------
+// Добавление нового элемента (прежнее имя insert()).
+      auto
+      add_int( const _Key& _newData ) -> void
+        { insert( _newData ); }
+//--------------------------------------------------------------------
+      auto
+      contains( const _Key& _key ) const -> bool
+        {
+        Node*  _n = lower_node( _key );
+        return _n != nullptr && !_M_less( _key, _n->_S_data );
+        }
+//--------------------------------------------------------------------
+// Удаление ключа. false - такого ключа нет.
+      auto
+      erase( const _Key& _key ) -> bool
+        {
+        Node*  _n = lower_node( _key );
+        if( _n == nullptr || _M_less( _key, _n->_S_data ) )
+          { return false; }
+
+        /** У узла с двумя детьми ключ заменяется ключом следующего
+         *  узла, а удаляется следующий - у него нет левого ребенка.
+         */
+        if( _n->_S_leftChild != nullptr && _n->_S_rightChild != nullptr )
+          {
+          Node*  _next = leftmost( _n->_S_rightChild );
+          _n->_S_data = std::move( _next->_S_data );
+          _n = _next;
+          }
+
+        Node*  _child  = _n->_S_leftChild != nullptr ? _n->_S_leftChild : _n->_S_rightChild;
+        Node*  _parent = _n->_S_parent;
+
+        replace_child( _parent, _n, _child );
+        delete _n;
+        _M_size--;
+
+        /** После удаления высота может уменьшиться на всем пути к
+         *  корню, поэтому подъем идет до конца.
+         */
+        for( Node* _p = _parent; _p != nullptr; )
+          { _p = rebalance( _p )->_S_parent; }
+
+        return true;
+        }
+//--------------------------------------------------------------------
+// Итератор на первый ключ, не меньший _key.
+      auto
+      lower_bound( const _Key& _key ) const -> iterator
+        { return iterator( lower_node( _key ) ); }
+//--------------------------------------------------------------------
+      auto
+      begin() const -> iterator
+        { return iterator( _M_root == nullptr ? nullptr : leftmost( _M_root ) ); }
+//--------------------------------------------------------------------
+      auto
+      end() const -> iterator
+        { return iterator(); }
+//--------------------------------------------------------------------
+      auto
+      size() const -> __u64
+        { return _M_size; }
+//--------------------------------------------------------------------
+      auto
+      empty() const -> bool
+        { return _M_size == 0; }
+//--------------------------------------------------------------------
+      auto
+      height() const -> __s32
+        { return height( _M_root ); }
+//--------------------------------------------------------------------
+// Удаление всех узлов без рекурсии: узел удаляется, когда у него
+// не осталось детей.
+      auto
+      clear() -> void
+        {
+        Node*  _n = _M_root;
+
+        while( _n != nullptr )
+          {
+          if( _n->_S_leftChild != nullptr )
+            { _n = _n->_S_leftChild; }
+          else if( _n->_S_rightChild != nullptr )
+            { _n = _n->_S_rightChild; }
+          else
+            {
+            Node*  _parent = _n->_S_parent;
+            if( _parent != nullptr )
+              {
+              if( _parent->_S_leftChild == _n )
+                { _parent->_S_leftChild = nullptr; }
+              else
+                { _parent->_S_rightChild = nullptr; }
+              }
+            delete _n;
+            _n = _parent;
+            }
+          }
+
+        _M_root = nullptr;
+        _M_size = 0;
         }
 
     }; // class pbtree
@@ -0,0 +1,319 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для компонент связности графа.
+ */
+
+/**
+ *  (PTL) Patriarch library : pcomponents.h
+ */
+
+#pragma once
+#if !defined( __PTL_PCOMPONENTS_H__ )
+#define __PTL_PCOMPONENTS_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#if !defined( __PTL_PEXCEPT_H__ )
+#include "pexcept.h"
+#endif
+
+#if !defined( __PTL_PDISJOINT_SET_H__ )
+#include "pdisjoint_set.h"
+#endif
+
+#if !defined( __PTL_PCSR_H__ )
+#include "pcsr.h"
+#endif
+
+#if !defined( __PTL_PPARALLEL_H__ )
+#include "pparallel.h"
+#endif
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/*
+ * Компоненты связности неориентированного графа.
+ *
+ * Функции:
+ *   - connected_components() - метки компонент через union-find
+ *   - connected_components_parallel() - метки компонент CSR-графа
+ *     параллельным алгоритмом Afforest
+ *
+ * Метка вершины - наименьший номер вершины ее компоненты, поэтому
+ * результаты обеих функций совпадают поэлементно.
+ *
+ * Классы:
+ *   - pconnectivity - связность потока ребер, поступающих по одному
+ *
+ * @code
+ *   std::vector<ptl::__u32> label = ptl::connected_components( graph );
+ *
+ *   ptl::pconnectivity  conn;
+ *   conn.add_edge( 3, 7 );
+ *   bool joined = conn.connected( 3, 7 );
+ * @endcode
+ */
+
+namespace ptl
+  {
+//--------------------------------------------------------------------
+// Метки компонент связности графа с курсорами смежности.
+// Каждое ребро объединяет множества своих концов; затем каждой
+// вершине назначается наименьший номер вершины ее множества.
+  template <typename _Graph>
+    auto
+    connected_components( const _Graph& __g ) -> std::vector<__u32>
+      {
+      __u32          __n{ __g.vertex_bound() };
+      pdisjoint_set  __ds( __n );
+
+      for( __u32 __v{ 0 }; __v < __n; __v++ )
+        {
+        for( auto __c = __g.adj_begin( __v );
+             __c != __g.adj_end( __v );
+             __c = __g.adj_next( __v, __c ) )
+          { __ds.unite( __v, __g.adj_target( __v, __c ) ); }
+        }
+
+      /** Первая по номеру вершина множества задает его метку.
+       */
+      std::vector<__u32>  __min( __n, 0xFFFFFFFFu );
+      std::vector<__u32>  __label( __n );
+
+      for( __u32 __v{ 0 }; __v < __n; __v++ )
+        {
+        __u32  __r = __ds.find( __v );
+        if( __min[__r] == 0xFFFFFFFFu )
+          { __min[__r] = __v; }
+        __label[__v] = __min[__r];
+        }
+
+      return __label;
+      }
+
+  namespace __detail
+    {
+//--------------------------------------------------------------------
+// Связывание деревьев вершин __u и __v для Afforest.
+// Корень с большим номером подвешивается к меньшему через CAS,
+// поэтому корень компоненты всегда - ее наименьшая вершина.
+    inline auto
+    afforest_link( std::atomic<__u32>* __comp, __u32 __u, __u32 __v ) -> void
+      {
+      __u32  __p1 = __comp[__u].load( std::memory_order_relaxed );
+      __u32  __p2 = __comp[__v].load( std::memory_order_relaxed );
+
+      while( __p1 != __p2 )
+        {
+        __u32  __high   = __p1 > __p2 ? __p1 : __p2;
+        __u32  __low    = __p1 + __p2 - __high;
+        __u32  __p_high = __comp[__high].load( std::memory_order_relaxed );
+
+        if( __p_high == __low )
+          { break; }
+
+        if( __p_high == __high
+            && __comp[__high].compare_exchange_strong(
+                 __p_high, __low, std::memory_order_relaxed ) )
+          { break; }
+
+        __p1 = __comp[__comp[__high].load( std::memory_order_relaxed )]
+                 .load( std::memory_order_relaxed );
+        __p2 = __comp[__low].load( std::memory_order_relaxed );
+        }
+      }
+//--------------------------------------------------------------------
+// Сжатие путей: каждая вершина указывает прямо на корень.
+    inline auto
+    afforest_compress( std::atomic<__u32>* __comp, __u32 __n,
+                       __u32 __threads ) -> void
+      {
+      parallel_for( 0, __n, __threads, [&]( __u64 __i )
+        {
+        __u32  __v = static_cast<__u32>( __i );
+
+        for( ;; )
+          {
+          __u32  __p  = __comp[__v].load( std::memory_order_relaxed );
+          __u32  __gp = __comp[__p].load( std::memory_order_relaxed );
+          if( __p == __gp )
+            { break; }
+          __comp[__v].store( __gp, std::memory_order_relaxed );
+          }
+        } );
+      }
+    } // namespace __detail
+//--------------------------------------------------------------------
+// Метки компонент связности симметричного CSR-графа (Afforest).
+// 1. Связываются первые __rounds соседей каждой вершины - этого
+//    обычно хватает, чтобы собрать самую большую компоненту.
+// 2. По выборке вершин определяется самая частая компонента.
+// 3. Оставшиеся ребра просматриваются только у вершин вне нее:
+//    ребро из нее во внешнюю вершину будет найдено с другой стороны.
+  inline auto
+  connected_components_parallel( const pcsr_view& __g,
+                                 __u32 __threads = hardware_threads(),
+                                 __u32 __rounds  = 2 ) -> std::vector<__u32>
+    {
+    __u32  __n{ __g.vertex_bound() };
+
+    std::unique_ptr<std::atomic<__u32>[]>  __comp( new std::atomic<__u32>[__n] );
+
+    parallel_for( 0, __n, __threads, [&]( __u64 __i )
+      { __comp[__i].store( static_cast<__u32>( __i ), std::memory_order_relaxed ); } );
+
+    const __u64*  __off = __g.offsets();
+    const __u32*  __nbr = __g.neighbors();
+
+    for( __u32 __r{ 0 }; __r < __rounds; __r++ )
+      {
+      parallel_for( 0, __n, __threads, [&]( __u64 __i )
+        {
+        if( __off[__i] + __r < __off[__i + 1] )
+          {
+          __detail::afforest_link( __comp.get(), static_cast<__u32>( __i ),
+                                   __nbr[__off[__i] + __r] );
+          }
+        } );
+      __detail::afforest_compress( __comp.get(), __n, __threads );
+      }
+
+    /** Самая частая компонента по детерминированной выборке.
+     */
+    __u32  __largest{ 0 };
+
+    if( __n > 0 )
+      {
+      const __u32         __samples{ 1024 };
+      std::vector<__u32>  __seen; // встреченные компоненты
+      std::vector<__u32>  __hits; // сколько раз встречена каждая
+      __u64               __x{ 0x9E3779B97F4A7C15ULL };
+
+      for( __u32 __s{ 0 }; __s < __samples; __s++ )
+        {
+        __x ^= __x << 13;
+        __x ^= __x >> 7;
+        __x ^= __x << 17;
+
+        __u32  __c = __comp[__x % __n].load( std::memory_order_relaxed );
+        __u32  __k{ 0 };
+
+        while( __k < __seen.size() && __seen[__k] != __c )
+          { __k++; }
+
+        if( __k == __seen.size() )
+          {
+          __seen.push_back( __c );
+          __hits.push_back( 0 );
+          }
+        __hits[__k]++;
+        }
+
+      __u32  __best{ 0 };
+      for( __u32 __k{ 0 }; __k < __seen.size(); __k++ )
+        {
+        if( __hits[__k] > __hits[__best] )
+          { __best = __k; }
+        }
+      __largest = __seen[__best];
+      }
+
+    parallel_for( 0, __n, __threads, [&]( __u64 __i )
+      {
+      if( __comp[__i].load( std::memory_order_relaxed ) == __largest )
+        { return; }
+
+      for( __u64 __e = __off[__i] + __rounds; __e < __off[__i + 1]; __e++ )
+        {
+        __detail::afforest_link( __comp.get(), static_cast<__u32>( __i ),
+                                 __nbr[__e] );
+        }
+      }, 256 );
+
+    __detail::afforest_compress( __comp.get(), __n, __threads );
+
+    std::vector<__u32>  __label( __n );
+    for( __u32 __v{ 0 }; __v < __n; __v++ )
+      { __label[__v] = __comp[__v].load( std::memory_order_relaxed ); }
+
+    return __label;
+    }
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Связность потока ребер.
+   * Ребра поступают по одному; связность поддерживается инкрементно,
+   * без пересчета с нуля. Вершины появляются по мере упоминания;
+   * номер 0xFFFFFFFF недопустим (число вершин не помещается в __u32).
+   *
+   * Методы:
+   *   - add_vertex() - добавление изолированной вершины
+   *   - add_edge() - добавление ребра
+   *   - connected() - проверка связности двух вершин
+   *   - component_count() - количество компонент
+   *   - vertex_count() - количество вершин
+   */
+  class pconnectivity
+    {
+    private:
+      pdisjoint_set  _M_sets; // Множества вершин компонент
+
+      auto
+      ensure( __u32 __v ) -> void
+        {
+        if( __v == 0xFFFFFFFF )
+          { throw pexception( "E: Номер вершины вне допустимого диапазона." ); }
+
+        if( __v >= _M_sets.size() )
+          { _M_sets.resize( __v + 1 ); }
+        }
+
+    public:
+      explicit
+      pconnectivity( __u32 __vertex_count = 0 )
+        : _M_sets( __vertex_count )
+        { }
+//--------------------------------------------------------------------
+// Добавление изолированной вершины с номером __v.
+      auto
+      add_vertex( __u32 __v ) -> void
+        { ensure( __v ); }
+//--------------------------------------------------------------------
+// Добавление ребра. Возвращает true, если ребро объединило
+// две разные компоненты.
+      auto
+      add_edge( __u32 __u, __u32 __v ) -> bool
+        {
+        ensure( __u > __v ? __u : __v );
+        return _M_sets.unite( __u, __v );
+        }
+//--------------------------------------------------------------------
+// Проверка связности двух вершин.
+      auto
+      connected( __u32 __u, __u32 __v ) -> bool
+        {
+        if( __u >= _M_sets.size() || __v >= _M_sets.size() )
+          { return __u == __v; }
+        return _M_sets.same( __u, __v );
+        }
+//--------------------------------------------------------------------
+// Количество компонент (изолированная вершина - отдельная компонента).
+      auto
+      component_count() const -> __u32
+        { return _M_sets.set_count(); }
+//--------------------------------------------------------------------
+// Количество вершин.
+      auto
+      vertex_count() const -> __u32
+        { return _M_sets.size(); }
+
+    }; // class pconnectivity
+  } // namespace ptl
+
+#endif // __PTL_PCOMPONENTS_H__
@@ -0,0 +1,1108 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для измерения производительности контейнеров.
+ */
+
+/**
+ *  (PTL) Patriarch library : pcontainerbench.h
+ */
+
+#pragma once
+#if !defined( __PTL_PCONTAINERBENCH_H__ )
+#define __PTL_PCONTAINERBENCH_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#if !defined( __PTL_PEXCEPT_H__ )
+#include "pexcept.h"
+#endif
+
+#if !defined( __PTL_PBENCH_H__ )
+#include "pbench.h"
+#endif
+
+#if !defined( __PTL_PGRAPHGEN_H__ )
+#include "pgraphgen.h"
+#endif
+
+#if !defined( __PTL_PPARALLEL_H__ )
+#include "pparallel.h"
+#endif
+
+#if !defined( __PTL_PLIST_H__ )
+#include "plist.h"
+#endif
+
+#if !defined( __PTL_PQUEUE_H__ )
+#include "pqueue.h"
+#endif
+
+#if !defined( __PTL_PMPMC_QUEUE_H__ )
+#include "pmpmc_queue.h"
+#endif
+
+#if !defined( __PTL_PSTACK_H__ )
+#include "pstack.h"
+#endif
+
+#if !defined( __PTL_PLOCKFREE_STACK_H__ )
+#include "plockfree_stack.h"
+#endif
+
+#if !defined( __PTL_PTREE_H__ )
+#include "ptree.h"
+#endif
+
+#if !defined( __PTL_PBTREE_H__ )
+#include "pbtree.h"
+#endif
+
+#if !defined( __PTL_PBPLUS_TREE_H__ )
+#include "pbplus_tree.h"
+#endif
+
+#if !defined( __PTL_PSKIPLIST_H__ )
+#include "pskiplist.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+ * Набор замеров для контейнеров библиотеки в сравнении с
+ * контейнерами std. Каждая фаза дает запись: контейнер, фаза,
+ * элементов в контейнере, операций, потоков, время, операций в
+ * секунду, пик резидентной памяти за фазу (см. pbench.h) и, для фаз
+ * из отдельных операций, медиану и 99-й процентиль задержки одной
+ * операции. Записи выводятся в CSV или JSON.
+ *
+ * Каждый замер заодно проверяет результат по эталону std (размеры,
+ * найденные значения, суммы); расхождение - исключение pexception.
+ * Поэтому прогон под ThreadSanitizer или AddressSanitizer служит и
+ * нагрузочным тестом.
+ *
+ * Классы:
+ *   - pcontainer_record - результат одной фазы
+ *   - pcontainer_bench - выполнение фаз и вывод результатов
+ *
+ * Функции:
+ *   - bench_lists() - plist и std::list: вставка в конец и чередование
+ *     удаления из начала со вставкой в конец
+ *   - bench_skiplists() - pskiplist, std::map и plist как упорядоченные
+ *     словари; pconcurrent_skiplist на 1, 2, 4, ... потоках
+ *   - bench_mpmc() - pmpmc_queue поэлементно и пачками против pqueue
+ *     под std::mutex при 1, 2, 4, ... производителях и потребителях
+ *   - bench_stacks() - plockfree_stack против pstack под std::mutex
+ *     на 1, 2, 4, ... потоках
+ *   - bench_trees() - ptree: широкое дерево (по 10000 детей у вершины)
+ *     и 10-ичное; построение, поиск, обходы, свертка, удаление
+ *   - bench_avl() - pbtree и std::set: вставка по возрастанию и в
+ *     случайном порядке с проверкой высоты, поиск, обход, удаление
+ *   - bench_bplus() - pbplus_tree и std::map: вставка, bulk_load(),
+ *     задержка поиска (медиана и 99-й процентиль), диапазон, удаление
+ *   - run_container_benchmarks() - полный прогон
+ *
+ * @code
+ *   int main()
+ *     {
+ *     ptl::run_container_benchmarks( std::cout, 1000000 );
+ *     return 0;
+ *     }
+ * @endcode
+ */
+
+namespace ptl
+  {
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Результат одной фазы замера.
+   */
+  struct pcontainer_record
+    {
+    std::string  _S_container;          // контейнер
+    std::string  _S_phase;              // фаза
+    __u64        _S_elements{ 0 };      // элементов в контейнере
+    __u64        _S_operations{ 0 };    // операций за фазу
+    __u32        _S_threads{ 1 };       // потоков
+    double       _S_seconds{ 0.0 };     // время фазы
+    double       _S_ops_per_second{ 0.0 };
+    // Задержка одной операции: медиана и 99-й процентиль
+    // (0 - задержки отдельных операций не замерялись).
+    double       _S_p50_seconds{ 0.0 };
+    double       _S_p99_seconds{ 0.0 };
+    __u64        _S_peak_rss_kb{ 0 };   // пик резидентной памяти за фазу
+    bool         _S_phase_rss{ false }; // false - пик процесса с запуска
+    };
+
+  namespace __detail
+    {
+    // Проверка результата замера.
+    inline auto
+    bench_expect( bool __ok, const char* __what ) -> void
+      {
+      if( !__ok )
+        { throw pexception( __what ); }
+      }
+
+    // Число потоков многопоточных фаз: 1, 2, 4, ... до __max.
+    inline auto
+    bench_threads( __u32 __max ) -> std::vector<__u32>
+      {
+      std::vector<__u32>  __counts;
+      for( __u32 __t{ 1 }; __t <= __max; __t *= 2 )
+        { __counts.push_back( __t ); }
+      return __counts;
+      }
+
+    // __n различных псевдослучайных ключей: умножение на нечетную
+    // константу - перестановка чисел __u32.
+    inline auto
+    bench_keys( __u32 __n, __u64 __seed ) -> std::vector<__u32>
+      {
+      std::vector<__u32>  __keys( __n );
+      for( __u32 __i{ 0 }; __i < __n; __i++ )
+        { __keys[__i] = static_cast<__u32>( ( __i + __seed ) * 2654435761ULL ); }
+      return __keys;
+      }
+
+    // Случайная перестановка номеров 0..__n-1 (Фишер-Йетс): порядок
+    // запросов, не совпадающий с порядком вставки, чтобы поиск не
+    // получал даром локальность выделения памяти.
+    inline auto
+    bench_order( __u32 __n, __u64 __seed ) -> std::vector<__u32>
+      {
+      std::vector<__u32>  __order( __n );
+      psplitmix64         __rng( __seed );
+
+      for( __u32 __i{ 0 }; __i < __n; __i++ )
+        { __order[__i] = __i; }
+      for( __u32 __i = __n; __i > 1; __i-- )
+        { std::swap( __order[__i - 1], __order[__rng.below( __i )] ); }
+      return __order;
+      }
+
+    // Передача чисел 0..__n-1 от __t производителей __t потребителям
+    // пачками до __batch штук. __push( data, k ) кладет до k чисел,
+    // __pop( out, k ) забирает до k; обе возвращают, сколько вышло
+    // (0 - очередь заполнена или пуста, поток уступает процессор).
+    // Возвращает сумму полученных чисел.
+    template <typename _Push, typename _Pop>
+      inline auto
+      bench_transfer( __u32 __n, __u32 __t, __u32 __batch,
+                      _Push __push, _Pop __pop ) -> __u64
+        {
+        std::atomic<__u64>        __popped{ 0 };
+        std::atomic<__u64>        __sum{ 0 };
+        std::vector<std::thread>  __workers;
+
+        for( __u32 __p{ 0 }; __p < __t; __p++ )
+          {
+          __workers.emplace_back( [&, __p]()
+            {
+            std::vector<__u32>  __buf;
+            for( __u64 __i = __p; __i < __n; )
+              {
+              __buf.clear();
+              for( ; __i < __n && __buf.size() < __batch; __i += __t )
+                { __buf.push_back( static_cast<__u32>( __i ) ); }
+
+              for( __u64 __done{ 0 }; __done < __buf.size(); )
+                {
+                __u64  __k = __push( __buf.data() + __done, __buf.size() - __done );
+                if( __k == 0 )
+                  { std::this_thread::yield(); }
+                __done += __k;
+                }
+              }
+            } );
+
+          __workers.emplace_back( [&]()
+            {
+            std::vector<__u32>  __buf( __batch );
+            __u64               __local{ 0 };
+
+            while( __popped.load( std::memory_order_relaxed ) < __n )
+              {
+              __u64  __k = __pop( __buf.data(), __batch );
+              if( __k == 0 )
+                {
+                std::this_thread::yield();
+                continue;
+                }
+              for( __u64 __j{ 0 }; __j < __k; __j++ )
+                { __local += __buf[__j]; }
+              __popped.fetch_add( __k, std::memory_order_relaxed );
+              }
+            __sum.fetch_add( __local, std::memory_order_relaxed );
+            } );
+          }
+
+        for( std::thread& __w : __workers )
+          { __w.join(); }
+
+        bench_expect( __popped.load() == __n,
+                      "E: очередь выдала не столько элементов, сколько получила." );
+        return __sum.load();
+        }
+
+    // Чередование вставки и снятия на __t потоках: поток __p кладет
+    // числа __p, __p + __t, ... меньше __n через __push( x ) и после
+    // каждой вставки снимает одно число через __pop( x ) (false -
+    // пусто). Возвращает сумму снятых чисел.
+    template <typename _Push, typename _Pop>
+      inline auto
+      bench_push_pop( __u32 __n, __u32 __t, _Push __push, _Pop __pop ) -> __u64
+        {
+        std::atomic<__u64>        __sum{ 0 };
+        std::vector<std::thread>  __workers;
+
+        for( __u32 __p{ 0 }; __p < __t; __p++ )
+          {
+          __workers.emplace_back( [&, __p]()
+            {
+            __u64  __local{ 0 };
+            for( __u64 __i = __p; __i < __n; __i += __t )
+              {
+              __u32  __x{ 0 };
+              __push( static_cast<__u32>( __i ) );
+              if( __pop( __x ) )
+                { __local += __x; }
+              }
+            __sum.fetch_add( __local, std::memory_order_relaxed );
+            } );
+          }
+
+        for( std::thread& __w : __workers )
+          { __w.join(); }
+        return __sum.load();
+        }
+
+    // Наибольшая возможная высота АВЛ-дерева из __n узлов: у самого
+    // разреженного дерева высоты h N(h) = N(h-1) + N(h-2) + 1 узлов.
+    inline auto
+    avl_max_height( __u64 __n ) -> __s32
+      {
+      __u64  __prev{ 0 };  // N(h - 1)
+      __u64  __curr{ 1 };  // N(h)
+      __s32  __h = __n == 0 ? 0 : 1;
+
+      while( __n > 0 )
+        {
+        __u64  __next = __curr + __prev + 1;
+        if( __next > __n )
+          { break; }
+        __prev = __curr;
+        __curr = __next;
+        __h++;
+        }
+      return __h;
+      }
+    } // namespace __detail
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Выполнение фаз замера и накопление записей.
+   *
+   * Методы:
+   *   - measure() - замер фазы целиком
+   *   - measure_latency() - замер фазы из отдельных операций
+   *   - records() - накопленные записи
+   *   - write_csv() - вывод записей в CSV
+   *   - write_json() - вывод записей в JSON
+   */
+  class pcontainer_bench
+    {
+    private:
+      std::vector<pcontainer_record>  _M_records;
+      __u64                           _M_checksum{ 0 }; // Результаты фаз, чтобы
+                                                        // их не удалил оптимизатор
+
+    public:
+//--------------------------------------------------------------------
+// Замер фазы __f() из __operations операций на __threads потоках.
+// Возвращает время.
+      template <typename _Func>
+        auto
+        measure( const std::string& __container, const std::string& __phase,
+                 __u64 __elements, __u64 __operations, __u32 __threads,
+                 _Func __f ) -> double
+          {
+          bool  __reset = reset_peak_rss();
+
+          auto  __start = std::chrono::steady_clock::now();
+          _M_checksum += __f();
+          auto  __stop = std::chrono::steady_clock::now();
+
+          pcontainer_record  __r;
+          __r._S_container   = __container;
+          __r._S_phase       = __phase;
+          __r._S_elements    = __elements;
+          __r._S_operations  = __operations;
+          __r._S_threads     = __threads;
+          __r._S_seconds     = std::chrono::duration<double>( __stop - __start ).count();
+          __r._S_peak_rss_kb = peak_rss_kb();
+          __r._S_phase_rss   = __reset;
+          if( __r._S_seconds > 0.0 )
+            { __r._S_ops_per_second = static_cast<double>( __operations ) / __r._S_seconds; }
+
+          _M_records.push_back( __r );
+          return __r._S_seconds;
+          }
+//--------------------------------------------------------------------
+// Замер фазы из __count операций __f( i ), каждая засекается
+// отдельно. В задержку входит и вызов часов (десятки наносекунд).
+      template <typename _Func>
+        auto
+        measure_latency( const std::string& __container, const std::string& __phase,
+                         __u64 __elements, __u64 __count, _Func __f ) -> double
+          {
+          typedef std::chrono::steady_clock  _Clock;
+
+          std::vector<double>  __latency( __count );
+          bool                 __reset = reset_peak_rss();
+
+          auto  __start = _Clock::now();
+          for( __u64 __i{ 0 }; __i < __count; __i++ )
+            {
+            auto  __q = _Clock::now();
+            _M_checksum += __f( __i );
+            __latency[__i] = std::chrono::duration<double>( _Clock::now() - __q ).count();
+            }
+          auto  __stop = _Clock::now();
+
+          std::sort( __latency.begin(), __latency.end() );
+
+          pcontainer_record  __r;
+          __r._S_container   = __container;
+          __r._S_phase       = __phase;
+          __r._S_elements    = __elements;
+          __r._S_operations  = __count;
+          __r._S_seconds     = std::chrono::duration<double>( __stop - __start ).count();
+          __r._S_p50_seconds = latency_percentile( __latency, 0.50 );
+          __r._S_p99_seconds = latency_percentile( __latency, 0.99 );
+          __r._S_peak_rss_kb = peak_rss_kb();
+          __r._S_phase_rss   = __reset;
+          if( __r._S_seconds > 0.0 )
+            { __r._S_ops_per_second = static_cast<double>( __count ) / __r._S_seconds; }
+
+          _M_records.push_back( __r );
+          return __r._S_seconds;
+          }
+//--------------------------------------------------------------------
+      auto
+      records() const -> const std::vector<pcontainer_record>&
+        { return _M_records; }
+//--------------------------------------------------------------------
+// Вывод записей в CSV с заголовком.
+      auto
+      write_csv( std::ostream& __out ) const -> void
+        {
+        __out << "container,phase,elements,operations,threads,seconds,"
+                 "ops_per_second,p50_seconds,p99_seconds,peak_rss_kb,phase_rss\n";
+        for( const pcontainer_record& __r : _M_records )
+          {
+          __out << __r._S_container << ',' << __r._S_phase << ','
+                << __r._S_elements << ',' << __r._S_operations << ','
+                << __r._S_threads << ',' << __r._S_seconds << ','
+                << __r._S_ops_per_second << ',' << __r._S_p50_seconds << ','
+                << __r._S_p99_seconds << ',' << __r._S_peak_rss_kb << ','
+                << __r._S_phase_rss << '\n';
+          }
+        }
+//--------------------------------------------------------------------
+// Вывод записей в JSON - массив объектов с полями как в CSV.
+// Имена контейнеров и фаз не экранируются.
+      auto
+      write_json( std::ostream& __out ) const -> void
+        {
+        __out << "[\n";
+        for( __u64 __i{ 0 }; __i < _M_records.size(); __i++ )
+          {
+          const pcontainer_record&  __r = _M_records[__i];
+          __out << "  {\"container\": \"" << __r._S_container
+                << "\", \"phase\": \"" << __r._S_phase
+                << "\", \"elements\": " << __r._S_elements
+                << ", \"operations\": " << __r._S_operations
+                << ", \"threads\": " << __r._S_threads
+                << ", \"seconds\": " << __r._S_seconds
+                << ", \"ops_per_second\": " << __r._S_ops_per_second
+                << ", \"p50_seconds\": " << __r._S_p50_seconds
+                << ", \"p99_seconds\": " << __r._S_p99_seconds
+                << ", \"peak_rss_kb\": " << __r._S_peak_rss_kb
+                << ", \"phase_rss\": " << ( __r._S_phase_rss ? "true" : "false" ) << '}'
+                << ( __i + 1 < _M_records.size() ? ",\n" : "\n" );
+          }
+        __out << "]\n";
+        }
+
+    }; // class pcontainer_bench
+//--------------------------------------------------------------------
+// Списки: __n вставок в конец (push), затем __n шагов чередования
+// удаления из начала со вставкой в конец (churn) - очередь на списке,
+// при которой узлы постоянно освобождаются и выделяются снова. Для
+// plist узлы идут через pnode_pool, для std::list - через operator new.
+  inline auto
+  bench_lists( pcontainer_bench& __bench, __u32 __n ) -> void
+    {
+      {
+      plist<__u32>  __list;
+
+      __bench.measure( "plist", "push", __n, __n, 1, [&]()
+        {
+        for( __u32 __i{ 0 }; __i < __n; __i++ )
+          { __list.push( __i ); }
+        return static_cast<__u64>( __list.size() );
+        } );
+
+      __bench.measure( "plist", "churn", __n, __n, 1, [&]()
+        {
+        for( __u32 __i{ 0 }; __i < __n; __i++ )
+          {
+          __list.remove_position( 0 );
+          __list.push( __n + __i );
+          }
+        return static_cast<__u64>( __list.size() );
+        } );
+
+      __detail::bench_expect( __list.size() == __n
+                              && ( __n == 0 || ( __list.find( 2 * __n - 1 )
+                                                 && !__list.find( __n - 1 ) ) ),
+                              "E: plist: неверное содержимое после замера." );
+      }
+
+      {
+      std::list<__u32>  __list;
+
+      __bench.measure( "std::list", "push", __n, __n, 1, [&]()
+        {
+        for( __u32 __i{ 0 }; __i < __n; __i++ )
+          { __list.push_back( __i ); }
+        return static_cast<__u64>( __list.size() );
+        } );
+
+      __bench.measure( "std::list", "churn", __n, __n, 1, [&]()
+        {
+        for( __u32 __i{ 0 }; __i < __n; __i++ )
+          {
+          __list.pop_front();
+          __list.push_back( __n + __i );
+          }
+        return static_cast<__u64>( __list.size() );
+        } );
+
+      __detail::bench_expect( __list.size() == __n
+                              && ( __n == 0 || __list.front() == __n ),
+                              "E: std::list: неверное содержимое после замера." );
+      }
+    }
+//--------------------------------------------------------------------
+// Упорядоченные словари с ключами и значениями по 4 байта: вставка
+// __n псевдослучайных ключей, поиск каждого в случайном порядке (с
+// задержкой отдельного поиска), обход всех пар по возрастанию и удаление половины.
+// pskiplist сверяется с std::map. plist - неупорядоченный список с
+// поиском за O(n), поэтому для него берется не больше 10000 ключей.
+//
+// pconcurrent_skiplist на каждом числе потоков из __thread_counts:
+// параллельная вставка тех же ключей, затем смешанная фаза, в которой
+// потоки одновременно удаляют ключи с нечетными номерами и ищут ключи
+// с четными. Итог сверяется поключево.
+  inline auto
+  bench_skiplists( pcontainer_bench& __bench, __u32 __n, __u64 __seed,
+                   const std::vector<__u32>& __thread_counts ) -> void
+    {
+    std::vector<__u32>  __keys  = __detail::bench_keys( __n, __seed );
+    std::vector<__u32>  __order = __detail::bench_order( __n, __seed );
+    __u64               __map_sum{ 0 };
+
+      {
+      std::map<__u32, __u32>  __map;
+
+      __bench.measure( "std::map", "insert", __n, __n, 1, [&]()
+        {
+        for( __u32 __i{ 0 }; __i < __n; __i++ )
+          { __map.emplace( __keys[__i], __i ); }
+        return static_cast<__u64>( __map.size() );
+        } );
+
+      __bench.measure_latency( "std::map", "find", __n, __n, [&]( __u64 __i )
+        { return static_cast<__u64>( __map.find( __keys[__order[__i]] )->second ); } );
+
+      __bench.measure( "std::map", "range", __n, __n, 1, [&]()
+        {
+        for( const auto& __kv : __map )
+          { __map_sum += __kv.second; }
+        return __map_sum;
+        } );
+
+      __bench.measure( "std::map", "erase", __n, __n / 2, 1, [&]()
+        {
+        for( __u32 __i{ 1 }; __i < __n; __i += 2 )
+          { __map.erase( __keys[__i] ); }
+        return static_cast<__u64>( __map.size() );
+        } );
+      }
+
+      {
+      pskiplist<__u32, __u32>  __list;
+      __u64                    __sum{ 0 };
+
+      __bench.measure( "pskiplist", "insert", __n, __n, 1, [&]()
+        {
+        for( __u32 __i{ 0 }; __i < __n; __i++ )
+          { __list.insert( __keys[__i], __i ); }
+        return __list.size();
+        } );
+
+      __bench.measure_latency( "pskiplist", "find", __n, __n, [&]( __u64 __i )
+        {
+        __u32*  __v = __list.find( __keys[__order[__i]] );
+        __detail::bench_expect( __v != nullptr && *__v == __order[__i],
+                                "E: pskiplist: find() вернул не то значение." );
+        return static_cast<__u64>( *__v );
+        } );
+
+      __bench.measure( "pskiplist", "range", __n, __n, 1, [&]()
+        {
+        __list.range( 0, 0xFFFFFFFF, [&]( __u32, __u32 __v ) { __sum += __v; } );
+        if( __list.contains( 0xFFFFFFFF ) )
+          { __sum += *__list.find( 0xFFFFFFFF ); }
+        return __sum;
+        } );
+
+      __bench.measure( "pskiplist", "erase", __n, __n / 2, 1, [&]()
+        {
+        for( __u32 __i{ 1 }; __i < __n; __i += 2 )
+          { __list.erase( __keys[__i] ); }
+        return __list.size();
+        } );
+
+      __detail::bench_expect( __sum == __map_sum && __list.size() == __n - __n / 2,
+                              "E: pskiplist расходится с std::map." );
+      for( __u32 __i{ 0 }; __i < __n; __i++ )
+        {
+        __detail::bench_expect( __list.contains( __keys[__i] ) == ( __i % 2 == 0 ),
+                                "E: pskiplist: неверное содержимое после erase()." );
+        }
+      }
+
+      {
+      __u32         __m = __n < 10000 ? __n : 10000;
+      plist<__u32>  __list;
+
+      __bench.measure( "plist", "insert", __m, __m, 1, [&]()
+        {
+        for( __u32 __i{ 0 }; __i < __m; __i++ )
+          { __list.push( __keys[__i] ); }
+        return static_cast<__u64>( __list.size() );
+        } );
+
+      __bench.measure_latency( "plist", "find", __m, __m, [&]( __u64 __i )
+        { return static_cast<__u64>( __list.find( __keys[__i] ) ); } );
+      }
+
+    for( __u32 __t : __thread_counts )
+      {
+      pconcurrent_skiplist<__u32, __u32>  __list;
+
+      __bench.measure( "pconcurrent_skiplist", "insert", __n, __n, __t, [&]()
+        {
+        parallel_for( 0, __n, __t, [&]( __u64 __i )
+          { __list.insert( __keys[__i], static_cast<__u32>( __i ) ); }, 64 );
+        return __list.size();
+        } );
+
+      __bench.measure( "pconcurrent_skiplist", "mixed", __n, __n, __t, [&]()
+        {
+        std::atomic<__u64>  __found{ 0 };
+        parallel_for( 0, __n, __t, [&]( __u64 __i )
+          {
+          if( __i % 2 == 1 )
+            { __list.erase( __keys[__i] ); }
+          else if( __list.contains( __keys[__i] ) )
+            { __found.fetch_add( 1, std::memory_order_relaxed ); }
+          }, 64 );
+        return __found.load();
+        } );
+
+      __list.reclaim();
+
+      __detail::bench_expect( __list.size() == __n - __n / 2,
+                              "E: pconcurrent_skiplist: неверный размер." );
+      for( __u32 __i{ 0 }; __i < __n; __i++ )
+        {
+        __u32  __v{ 0 };
+        bool   __has = __list.find( __keys[__i], __v );
+        __detail::bench_expect( __has == ( __i % 2 == 0 ) && ( !__has || __v == __i ),
+                                "E: pconcurrent_skiplist: неверное содержимое." );
+        }
+      }
+    }
+//--------------------------------------------------------------------
+// Очереди между потоками: __n чисел от __t производителей __t
+// потребителям (всего 2 * __t потоков) для каждого __t из
+// __thread_counts. pqueue под одним std::mutex - прежний способ
+// разделить очередь между потоками; pmpmc_queue емкостью 1024 -
+// поэлементно (transfer) и пачками по 32 через try_push_n() и
+// try_pop_n() (transfer_batch). Каждая фаза сверяет число и сумму
+// полученных элементов.
+  inline auto
+  bench_mpmc( pcontainer_bench& __bench, __u32 __n,
+              const std::vector<__u32>& __thread_counts ) -> void
+    {
+    const __u64  __expect = static_cast<__u64>( __n ) * ( __n - 1ULL ) / 2;
+
+    for( __u32 __t : __thread_counts )
+      {
+        {
+        pqueue<__u32>  __queue;
+        std::mutex     __lock;
+        __u64          __sum{ 0 };
+
+        __bench.measure( "pqueue+mutex", "transfer", __n, __n, 2 * __t, [&]()
+          {
+          __sum = __detail::bench_transfer( __n, __t, 1,
+            [&]( const __u32* __data, __u64 __k ) -> __u64
+              {
+              std::lock_guard<std::mutex>  __guard( __lock );
+              for( __u64 __j{ 0 }; __j < __k; __j++ )
+                { __queue.en_queue( __data[__j] ); }
+              return __k;
+              },
+            [&]( __u32* __out, __u64 __k ) -> __u64
+              {
+              std::lock_guard<std::mutex>  __guard( __lock );
+              __u64  __j{ 0 };
+              for( ; __j < __k && !__queue.is_empty(); __j++ )
+                { __out[__j] = __queue.de_queue(); }
+              return __j;
+              } );
+          return __sum;
+          } );
+
+        __detail::bench_expect( __sum == __expect && __queue.is_empty(),
+                                "E: pqueue+mutex: неверная сумма элементов." );
+        }
+
+      for( __u32 __batch : { 1u, 32u } )
+        {
+        pmpmc_queue<__u32>  __queue( 1024 );
+        __u64               __sum{ 0 };
+
+        __bench.measure( "pmpmc_queue", __batch == 1 ? "transfer" : "transfer_batch",
+                         __n, __n, 2 * __t, [&]()
+          {
+          __sum = __detail::bench_transfer( __n, __t, __batch,
+            [&]( const __u32* __data, __u64 __k )
+              { return __queue.try_push_n( __data, __k ); },
+            [&]( __u32* __out, __u64 __k )
+              { return __queue.try_pop_n( __out, __k ); } );
+          return __sum;
+          } );
+
+        __detail::bench_expect( __sum == __expect && __queue.size_approx() == 0,
+                                "E: pmpmc_queue: неверная сумма элементов." );
+        }
+      }
+    }
+//--------------------------------------------------------------------
+// Стеки под конкуренцией потоков: для каждого __t из __thread_counts
+// __t потоков чередуют вставку и снятие __n чисел на одном стеке.
+// pstack под одним std::mutex сравнивается с plockfree_stack; у
+// последнего остаток снимается через pop_all(). Сумма снятых чисел
+// сверяется с суммой вставленных.
+  inline auto
+  bench_stacks( pcontainer_bench& __bench, __u32 __n,
+                const std::vector<__u32>& __thread_counts ) -> void
+    {
+    const __u64  __expect = static_cast<__u64>( __n ) * ( __n - 1ULL ) / 2;
+
+    for( __u32 __t : __thread_counts )
+      {
+        {
+        pstack<__u32>  __stack;
+        std::mutex     __lock;
+        __u64          __sum{ 0 };
+
+        __bench.measure( "pstack+mutex", "push_pop", __n, 2ULL * __n, __t, [&]()
+          {
+          __sum = __detail::bench_push_pop( __n, __t,
+            [&]( __u32 __x )
+              {
+              std::lock_guard<std::mutex>  __guard( __lock );
+              __stack.push( __x );
+              },
+            [&]( __u32& __x )
+              {
+              std::lock_guard<std::mutex>  __guard( __lock );
+              if( __stack.is_empty() )
+                { return false; }
+              __x = __stack.pop();
+              return true;
+              } );
+          while( !__stack.is_empty() )
+            { __sum += __stack.pop(); }
+          return __sum;
+          } );
+
+        __detail::bench_expect( __sum == __expect,
+                                "E: pstack+mutex: неверная сумма элементов." );
+        }
+
+        {
+        plockfree_stack<__u32>  __stack;
+        __u64                   __sum{ 0 };
+
+        __bench.measure( "plockfree_stack", "push_pop", __n, 2ULL * __n, __t, [&]()
+          {
+          __sum = __detail::bench_push_pop( __n, __t,
+            [&]( __u32 __x ) { __stack.push( __x ); },
+            [&]( __u32& __x ) { return __stack.try_pop( __x ); } );
+          __stack.pop_all( [&]( __u32 __x ) { __sum += __x; } );
+          return __sum;
+          } );
+
+        __detail::bench_expect( __sum == __expect && __stack.is_empty(),
+                                "E: plockfree_stack: неверная сумма элементов." );
+        }
+      }
+    }
+//--------------------------------------------------------------------
+// Деревья ptree двух форм примерно из __n вершин: широкое - корень,
+// k = __n / 10001 (не меньше 1) внутренних вершин и по 10000 детей у
+// каждой; 10-ичное - вершина i > 0 подвешена к (i - 1) / 10. Номер
+// вершины - ее порядковый номер i. Фазы: построение, поиск каждой
+// вершины по номеру в случайном порядке (с задержкой отдельного
+// поиска), прямой, обратный и поуровневый обходы, parallel_reduce на
+// пуле из каждого числа потоков из __thread_counts (пул создается вне
+// замера) и удаление k вершин с
+// переносом их детей. Количество и сумма номеров сверяются после
+// каждой фазы.
+  inline auto
+  bench_trees( pcontainer_bench& __bench, __u32 __n, __u64 __seed,
+               const std::vector<__u32>& __thread_counts ) -> void
+    {
+    const __u32  __fanout = 10000;
+    const __u32  __k      = __n / ( __fanout + 1 ) > 0 ? __n / ( __fanout + 1 ) : 1;
+
+    auto  __run = [&]( const std::string& __shape, __u32 __m, auto __parent )
+      {
+      ptree               __tree;
+      std::vector<__u32>  __order = __detail::bench_order( __m, __seed );
+      const __u64         __sum   = static_cast<__u64>( __m ) * ( __m - 1ULL ) / 2;
+
+      __bench.measure( "ptree", "build_" + __shape, __m, __m, 1, [&]()
+        {
+        __tree.reserve( __m );
+        __tree.set_root( 0 );
+        for( __u32 __i{ 1 }; __i < __m; __i++ )
+          { __tree.add_node( static_cast<__s32>( __parent( __i ) ), static_cast<__s32>( __i ) ); }
+        return __tree.size();
+        } );
+
+      __bench.measure_latency( "ptree", "find_" + __shape, __m, __m, [&]( __u64 __i )
+        {
+        __u32  __v = __tree.get_node_by_number( static_cast<__s32>( __order[__i] ) );
+        __detail::bench_expect( __v != ptree::npos
+                                && __tree.number( __v ) == static_cast<__s32>( __order[__i] ),
+                                "E: ptree: get_node_by_number() нашел не ту вершину." );
+        return static_cast<__u64>( __v );
+        } );
+
+      auto  __traverse = [&]( const std::string& __phase, auto __order_fn )
+        {
+        __u64  __count{ 0 };
+        __u64  __total{ 0 };
+
+        __bench.measure( "ptree", __phase + "_" + __shape, __m, __m, 1, [&]()
+          {
+          __order_fn( [&]( __u32 __v )
+            {
+            __count++;
+            __total += static_cast<__u64>( __tree.number( __v ) );
+            } );
+          return __total;
+          } );
+
+        __detail::bench_expect( __count == __m && __total == __sum,
+                                "E: ptree: обход прошел не все вершины." );
+        };
+
+      __traverse( "preorder", [&]( auto __f ) { __tree.preorder( __tree.root(), __f ); } );
+      __traverse( "postorder", [&]( auto __f ) { __tree.postorder( __tree.root(), __f ); } );
+      __traverse( "level_order", [&]( auto __f ) { __tree.level_order( __tree.root(), __f ); } );
+
+      for( __u32 __t : __thread_counts )
+        {
+        ptask_pool  __pool( __t );
+        __u64       __total{ 0 };
+
+        __bench.measure( "ptree", "reduce_" + __shape, __m, __m, __t, [&]()
+          {
+          __total = __tree.parallel_reduce( __tree.root(), __u64{ 0 },
+            [&]( __u32 __v ) { return static_cast<__u64>( __tree.number( __v ) ); },
+            []( __u64 __a, __u64 __b ) { return __a + __b; }, __pool );
+          return __total;
+          } );
+
+        __detail::bench_expect( __total == __sum,
+                                "E: ptree: parallel_reduce() дал неверную сумму." );
+        }
+
+      __u32  __erased = __k < __m ? __k : __m - 1;
+
+      __bench.measure( "ptree", "del_" + __shape, __m, __erased, 1, [&]()
+        {
+        for( __u32 __i{ 1 }; __i <= __erased; __i++ )
+          { __tree.del_node( static_cast<__s32>( __i ) ); }
+        return __tree.size();
+        } );
+
+      __u64  __count{ 0 };
+      __tree.preorder( __tree.root(), [&]( __u32 ) { __count++; } );
+      __detail::bench_expect( __tree.size() == __m - __erased && __count == __m - __erased,
+                              "E: ptree: неверное число вершин после del_node()." );
+      };
+
+    __run( "wide", 1 + __k * ( __fanout + 1 ), [&]( __u32 __i )
+      { return __i <= __k ? 0 : 1 + ( __i - __k - 1 ) / __fanout; } );
+
+    __run( "10ary", __n > 0 ? __n : 1, []( __u32 __i )
+      { return ( __i - 1 ) / 10; } );
+    }
+//--------------------------------------------------------------------
+// Деревья поиска с ключами по 8 байт: вставка ключей 0..__n-1 по
+// возрастанию (худший случай для несбалансированного дерева) и в
+// случайном порядке, поиск каждого ключа в случайном порядке (с
+// задержкой отдельного поиска), обход по возрастанию и удаление
+// нечетных ключей. pbtree сравнивается с std::set; после вставки
+// высота pbtree сверяется с границей АВЛ-дерева, после остальных фаз -
+// размер и содержимое.
+  inline auto
+  bench_avl( pcontainer_bench& __bench, __u32 __n, __u64 __seed ) -> void
+    {
+    std::vector<__u32>  __order = __detail::bench_order( __n, __seed );
+    const __u64         __sum   = static_cast<__u64>( __n ) * ( __n - 1ULL ) / 2;
+
+      {
+      std::set<__u64>  __set;
+
+      __bench.measure( "std::set", "insert_sorted", __n, __n, 1, [&]()
+        {
+        for( __u32 __i{ 0 }; __i < __n; __i++ )
+          { __set.insert( __set.end(), __i ); }
+        return static_cast<__u64>( __set.size() );
+        } );
+
+      __bench.measure_latency( "std::set", "find", __n, __n, [&]( __u64 __i )
+        { return static_cast<__u64>( __set.count( __order[__i] ) ); } );
+      }
+
+      {
+      pbtree<__u64>  __tree;
+      __u64          __total{ 0 };
+      __u64          __count{ 0 };
+      bool           __ascending{ true };
+
+      __bench.measure( "pbtree", "insert_sorted", __n, __n, 1, [&]()
+        {
+        for( __u32 __i{ 0 }; __i < __n; __i++ )
+          { __tree.insert( __i ); }
+        return __tree.size();
+        } );
+
+      __detail::bench_expect( __tree.size() == __n
+                              && __tree.height() <= __detail::avl_max_height( __n ),
+                              "E: pbtree: высота после вставки по возрастанию вне границы АВЛ." );
+
+      __bench.measure_latency( "pbtree", "find", __n, __n, [&]( __u64 __i )
+        {
+        bool  __has = __tree.contains( __order[__i] );
+        __detail::bench_expect( __has, "E: pbtree: contains() не нашел ключ." );
+        return static_cast<__u64>( __has );
+        } );
+
+      __bench.measure( "pbtree", "iterate", __n, __n, 1, [&]()
+        {
+        __u64  __prev{ 0 };
+        for( auto __it = __tree.begin(); __it != __tree.end(); ++__it )
+          {
+          __ascending = __ascending && ( __count == 0 || __prev < *__it );
+          __prev      = *__it;
+          __total    += *__it;
+          __count++;
+          }
+        return __total;
+        } );
+
+      __detail::bench_expect( __ascending && __count == __n && __total == __sum,
+                              "E: pbtree: обход расходится с вставленными ключами." );
+
+      __bench.measure( "pbtree", "erase", __n, __n / 2, 1, [&]()
+        {
+        for( __u32 __i{ 1 }; __i < __n; __i += 2 )
+          { __tree.erase( __i ); }
+        return __tree.size();
+        } );
+
+      __detail::bench_expect( __tree.size() == __n - __n / 2
+                              && __tree.height() <= __detail::avl_max_height( __tree.size() ),
+                              "E: pbtree: неверный размер или высота после erase()." );
+      for( __u32 __i{ 0 }; __i < __n; __i++ )
+        {
+        __detail::bench_expect( __tree.contains( __i ) == ( __i % 2 == 0 ),
+                                "E: pbtree: неверное содержимое после erase()." );
+        }
+      }
+
+      {
+      pbtree<__u64>  __tree;
+
+      __bench.measure( "pbtree", "insert_random", __n, __n, 1, [&]()
+        {
+        for( __u32 __i{ 0 }; __i < __n; __i++ )
+          { __tree.insert( __order[__i] ); }
+        return __tree.size();
+        } );
+
+      __detail::bench_expect( __tree.size() == __n
+                              && __tree.height() <= __detail::avl_max_height( __n ),
+                              "E: pbtree: высота после случайной вставки вне границы АВЛ." );
+      }
+    }
+//--------------------------------------------------------------------
+// Упорядоченные индексы с ключами и значениями по 8 байт: вставка
+// __n псевдослучайных ключей, поиск каждого в случайном порядке (с
+// задержкой отдельного поиска), обход всех пар диапазоном и удаление
+// половины. pbplus_tree сверяется с std::map. Затем pbplus_tree
+// строится заново через bulk_load() из отсортированных пар, и поиск
+// замеряется еще раз на плотно заполненных узлах.
+  inline auto
+  bench_bplus( pcontainer_bench& __bench, __u32 __n, __u64 __seed ) -> void
+    {
+    std::vector<__u32>              __keys  = __detail::bench_keys( __n, __seed );
+    std::vector<__u32>              __order = __detail::bench_order( __n, __seed );
+    std::map<__u64, __u64>          __map;
+    std::vector<std::pair<__u64, __u64>>  __sorted;
+    __u64                           __map_sum{ 0 };
+
+    __bench.measure( "std::map", "insert_u64", __n, __n, 1, [&]()
+      {
+      for( __u32 __i{ 0 }; __i < __n; __i++ )
+        { __map.emplace( __keys[__i], __i ); }
+      return static_cast<__u64>( __map.size() );
+      } );
+
+    __bench.measure_latency( "std::map", "find_u64", __n, __n, [&]( __u64 __i )
+      { return __map.find( __keys[__order[__i]] )->second; } );
+
+    for( const auto& __kv : __map )
+      {
+      __map_sum += __kv.second;
+      __sorted.push_back( __kv );
+      }
+
+      {
+      pbplus_tree<__u64, __u64>  __tree;
+      __u64                      __sum{ 0 };
+
+      __bench.measure( "pbplus_tree", "insert", __n, __n, 1, [&]()
+        {
+        for( __u32 __i{ 0 }; __i < __n; __i++ )
+          { __tree.insert( __keys[__i], __i ); }
+        return __tree.size();
+        } );
+
+      __bench.measure_latency( "pbplus_tree", "find", __n, __n, [&]( __u64 __i )
+        {
+        __u64*  __v = __tree.find( __keys[__order[__i]] );
+        __detail::bench_expect( __v != nullptr && *__v == __order[__i],
+                                "E: pbplus_tree: find() вернул не то значение." );
+        return *__v;
+        } );
+
+      __bench.measure( "pbplus_tree", "range", __n, __n, 1, [&]()
+        {
+        __tree.range( 0, ~0ULL, [&]( __u64, __u64 __v ) { __sum += __v; } );
+        return __sum;
+        } );
+
+      __bench.measure( "pbplus_tree", "erase", __n, __n / 2, 1, [&]()
+        {
+        for( __u32 __i{ 1 }; __i < __n; __i += 2 )
+          { __tree.erase( __keys[__i] ); }
+        return __tree.size();
+        } );
+
+      __detail::bench_expect( __sum == __map_sum && __tree.size() == __n - __n / 2,
+                              "E: pbplus_tree расходится с std::map." );
+      for( __u32 __i{ 0 }; __i < __n; __i++ )
+        {
+        __detail::bench_expect( __tree.contains( __keys[__i] ) == ( __i % 2 == 0 ),
+                                "E: pbplus_tree: неверное содержимое после erase()." );
+        }
+      }
+
+      {
+      pbplus_tree<__u64, __u64>  __tree;
+
+      __bench.measure( "pbplus_tree", "bulk_load", __n, __n, 1, [&]()
+        {
+        __tree.bulk_load( __sorted.begin(), __sorted.end() );
+        return __tree.size();
+        } );
+
+      __bench.measure_latency( "pbplus_tree", "find_bulk", __n, __n, [&]( __u64 __i )
+        {
+        __u64*  __v = __tree.find( __keys[__order[__i]] );
+        __detail::bench_expect( __v != nullptr && *__v == __order[__i],
+                                "E: pbplus_tree: find() после bulk_load() вернул не то значение." );
+        return *__v;
+        } );
+
+      __detail::bench_expect( __tree.size() == __n,
+                              "E: pbplus_tree: неверный размер после bulk_load()." );
+      }
+    }
+//--------------------------------------------------------------------
+// Полный прогон на __n элементах; многопоточные фазы - на 1, 2, 4,
+// ... до __max_threads потоках (больше, чем ядер, - для проверки
+// поведения при вытеснении). Результат - в CSV или JSON.
+  inline auto
+  run_container_benchmarks( std::ostream& __out, __u32 __n = 1000000,
+                            bool __json = false, __u64 __seed = 1,
+                            __u32 __max_threads = 32 ) -> void
+    {
+    pcontainer_bench    __bench;
+    std::vector<__u32>  __threads = __detail::bench_threads( __max_threads );
+
+    bench_lists( __bench, __n );
+    bench_skiplists( __bench, __n, __seed, __threads );
+    bench_mpmc( __bench, __n, __threads );
+    bench_stacks( __bench, __n, __threads );
+    bench_trees( __bench, __n, __seed, __threads );
+    bench_avl( __bench, __n, __seed );
+    bench_bplus( __bench, __n, __seed );
+
+    if( __json )
+      { __bench.write_json( __out ); }
+    else
+      { __bench.write_csv( __out ); }
+    }
+
+  } // namespace ptl
+
+#endif // __PTL_PCONTAINERBENCH_H__
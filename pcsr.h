@@ -0,0 +1,561 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для графа в формате CSR
+ * (compressed sparse row) и его двоичного файла.
+ */
+
+/**
+ *  (PTL) Patriarch library : pcsr.h
+ */
+
+#pragma once
+#if !defined( __PTL_PCSR_H__ )
+#define __PTL_PCSR_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#if !defined( __PTL_PEXCEPT_H__ )
+#include "pexcept.h"
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * Граф в формате CSR.
+ *
+ * Классы:
+ *   - pedge - ребро списка ребер (откуда, куда, вес)
+ *   - pcsr_view - представление CSR-графа только для чтения поверх
+ *     чужих массивов (памяти процесса или отображенного файла)
+ *   - pcsr_graph - CSR-граф, владеющий своими массивами
+ *   - pcsr_file - отображение (mmap) двоичного CSR-файла в память
+ *
+ * Функции:
+ *   - csr_convert() - преобразование текстового списка ребер
+ *                     в двоичный CSR-файл
+ *
+ * Формат файла (все числа little-endian, секции выровнены на 64 байта):
+ *   - заголовок pcsr_header (64 байта)
+ *   - offsets   : __u64[vertex_count + 1] - начало ребер каждой вершины
+ *   - neighbors : __u32[edge_count]       - концы ребер
+ *   - weights   : __u32[edge_count]       - веса ребер (необязательно)
+ *
+ * pcsr_view предоставляет курсоры смежности, поэтому алгоритмы из
+ * ptraversal.h работают прямо по отображенному файлу без разбора.
+ *
+ * @code
+ *   ptl::csr_convert( "edges.txt", "graph.csr", true );
+ *
+ *   ptl::pcsr_file  file( "graph.csr" );
+ *   auto order = ptl::dfs_preorder( file.view(), 0 );
+ * @endcode
+ */
+
+namespace ptl
+  {
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Ребро списка ребер.
+   */
+  struct pedge
+    {
+    __u32  _S_from;        // вершина-начало
+    __u32  _S_to;          // вершина-конец
+    __u32  _S_weight{ 1 }; // вес ребра
+    };
+//--------------------------------------------------------------------
+// Обмен двух ребер. Алгоритмы std (std::sort в pmst.h) вызывают swap
+// без квалификации, и по ADL для pedge находится и шаблон ptl::swap
+// из palgorithm.h, и std::swap; нешаблонная перегрузка точнее обоих
+// и снимает неоднозначность.
+  inline auto
+  swap( pedge& __a, pedge& __b ) noexcept -> void
+    {
+    pedge  __c = __a;
+    __a = __b;
+    __b = __c;
+    }
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Заголовок двоичного CSR-файла.
+   */
+  struct pcsr_header
+    {
+    __u64  _S_magic;        // сигнатура "PTLCSR01"
+    __u32  _S_version;      // версия формата
+    __u32  _S_flags;        // признаки pcsr_header::__weighted и т.д.
+    __u64  _S_vertex_count; // количество вершин
+    __u64  _S_edge_count;   // количество ребер (дуг)
+    __u64  _S_offsets;      // смещение секции offsets от начала файла
+    __u64  _S_neighbors;    // смещение секции neighbors
+    __u64  _S_weights;      // смещение секции weights (0 - весов нет)
+    __u64  _S_reserved;     // зарезервировано
+
+    static constexpr __u32  __weighted = 1; // в файле есть секция весов
+    static constexpr __u32  __directed = 2; // ребра не симметризованы
+
+    static constexpr __u64  __magic   = 0x313052534354504CULL; // "PTLCSR01"
+    static constexpr __u32  __version = 1;
+    static constexpr __u64  __align   = 64;
+    };
+
+  static_assert( sizeof( pcsr_header ) == 64,
+                 "pcsr_header должен занимать 64 байта" );
+
+  namespace __detail
+    {
+//--------------------------------------------------------------------
+// Формат хранит числа в little-endian и читается без
+// преобразования, поэтому на big-endian платформах не поддерживается.
+    inline auto
+    csr_check_endian() -> void
+      {
+#if defined( __BYTE_ORDER__ ) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      throw pexception( "E: Формат CSR поддерживается только на little-endian." );
+#endif
+      }
+//--------------------------------------------------------------------
+// Выравнивание смещения вверх до границы pcsr_header::__align.
+    inline auto
+    csr_align( __u64 __offset ) -> __u64
+      {
+      return ( __offset + pcsr_header::__align - 1 )
+             & ~( pcsr_header::__align - 1 );
+      }
+    } // namespace __detail
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Представление CSR-графа только для чтения.
+   * Не владеет памятью: массивы принадлежат pcsr_graph или pcsr_file.
+   *
+   * Методы:
+   *   - vertex_bound() - количество вершин
+   *   - edge_count() - количество ребер (дуг)
+   *   - degree() - количество исходящих ребер вершины
+   *   - is_weighted() - есть ли у ребер веса
+   *   - offsets(), neighbors(), weights() - массивы CSR
+   *   - adj_begin(), adj_end(), adj_next(), adj_target(), adj_weight() -
+   *     курсоры смежности
+   */
+  class pcsr_view
+    {
+    private:
+      __u32         _M_vertex_count{ 0 };
+      __u64         _M_edge_count{ 0 };
+      const __u64*  _M_offsets{ nullptr };
+      const __u32*  _M_neighbors{ nullptr };
+      const __u32*  _M_weights{ nullptr };
+
+    public:
+      pcsr_view() = default;
+
+      pcsr_view( __u32 __vertex_count, __u64 __edge_count,
+                 const __u64* __offsets, const __u32* __neighbors,
+                 const __u32* __weights )
+        : _M_vertex_count( __vertex_count ),
+          _M_edge_count( __edge_count ),
+          _M_offsets( __offsets ),
+          _M_neighbors( __neighbors ),
+          _M_weights( __weights )
+        { }
+//--------------------------------------------------------------------
+      auto
+      vertex_bound() const -> __u32
+        { return _M_vertex_count; }
+//--------------------------------------------------------------------
+      auto
+      edge_count() const -> __u64
+        { return _M_edge_count; }
+//--------------------------------------------------------------------
+      auto
+      degree( __u32 __v ) const -> __u64
+        { return _M_offsets[__v + 1] - _M_offsets[__v]; }
+//--------------------------------------------------------------------
+      auto
+      is_weighted() const -> bool
+        { return _M_weights != nullptr; }
+//--------------------------------------------------------------------
+      auto
+      offsets() const -> const __u64*
+        { return _M_offsets; }
+
+      auto
+      neighbors() const -> const __u32*
+        { return _M_neighbors; }
+
+      auto
+      weights() const -> const __u32*
+        { return _M_weights; }
+//--------------------------------------------------------------------
+// Курсор ребра - его индекс в массиве neighbors.
+      auto
+      adj_begin( __u32 __v ) const -> __u64
+        { return _M_offsets[__v]; }
+
+      auto
+      adj_end( __u32 __v ) const -> __u64
+        { return _M_offsets[__v + 1]; }
+
+      auto
+      adj_next( __u32, __u64 __c ) const -> __u64
+        { return __c + 1; }
+
+      auto
+      adj_target( __u32, __u64 __c ) const -> __u32
+        { return _M_neighbors[__c]; }
+
+      // Для невзвешенного графа вес каждого ребра равен 1.
+      auto
+      adj_weight( __u32, __u64 __c ) const -> __u32
+        { return _M_weights ? _M_weights[__c] : 1; }
+
+    }; // class pcsr_view
+//////////////////////////////////////////////////////////////////////
+  /*
+   * CSR-граф, владеющий своими массивами.
+   *
+   * Методы:
+   *   - view() - представление графа для алгоритмов
+   *   - save() - запись графа в двоичный CSR-файл
+   */
+  class pcsr_graph
+    {
+    private:
+      __u32               _M_vertex_count{ 0 };
+      bool                _M_directed{ true };
+      std::vector<__u64>  _M_offsets;
+      std::vector<__u32>  _M_neighbors;
+      std::vector<__u32>  _M_weights;
+
+    public:
+      pcsr_graph()
+        : _M_offsets( 1, 0 )
+        { }
+
+      /** Построение по списку ребер подсчетом степеней за O(n + m).
+       *  Для __symmetric каждое ребро добавляется в обе стороны.
+       *  Веса сохраняются, только если __weighted.
+       */
+      pcsr_graph( __u32 __vertex_count, const std::vector<pedge>& __edges,
+                  bool __symmetric, bool __weighted = false )
+        : _M_vertex_count( __vertex_count ),
+          _M_directed( !__symmetric ),
+          _M_offsets( static_cast<__u64>( __vertex_count ) + 1, 0 )
+        {
+        for( const pedge& __e : __edges )
+          {
+          if( __e._S_from >= __vertex_count || __e._S_to >= __vertex_count )
+            { throw pexception( "E: Такой вершины в графе нет." ); }
+
+          _M_offsets[__e._S_from + 1]++;
+          if( __symmetric )
+            { _M_offsets[__e._S_to + 1]++; }
+          }
+
+        for( __u32 __v{ 0 }; __v < __vertex_count; __v++ )
+          { _M_offsets[__v + 1] += _M_offsets[__v]; }
+
+        _M_neighbors.resize( _M_offsets[__vertex_count] );
+        if( __weighted )
+          { _M_weights.resize( _M_offsets[__vertex_count] ); }
+
+        /** Раскладываем ребра по позициям, сдвигая курсор каждой
+         *  вершины; после раскладки курсоры восстанавливаются.
+         */
+        std::vector<__u64>  __pos( _M_offsets.begin(), _M_offsets.end() - 1 );
+
+        for( const pedge& __e : __edges )
+          {
+          __u64  __i = __pos[__e._S_from]++;
+          _M_neighbors[__i] = __e._S_to;
+          if( __weighted )
+            { _M_weights[__i] = __e._S_weight; }
+
+          if( __symmetric )
+            {
+            __u64  __j = __pos[__e._S_to]++;
+            _M_neighbors[__j] = __e._S_from;
+            if( __weighted )
+              { _M_weights[__j] = __e._S_weight; }
+            }
+          }
+        }
+//--------------------------------------------------------------------
+      auto
+      view() const -> pcsr_view
+        {
+        return pcsr_view( _M_vertex_count, _M_neighbors.size(),
+                          _M_offsets.data(), _M_neighbors.data(),
+                          _M_weights.empty() ? nullptr : _M_weights.data() );
+        }
+//--------------------------------------------------------------------
+// Запись графа в двоичный CSR-файл.
+      auto
+      save( const std::string& __path ) const -> void
+        {
+        __detail::csr_check_endian();
+
+        pcsr_header  __h;
+        std::memset( &__h, 0, sizeof( __h ) );
+
+        __u64  __m = _M_neighbors.size();
+
+        __h._S_magic        = pcsr_header::__magic;
+        __h._S_version      = pcsr_header::__version;
+        __h._S_flags        = ( _M_weights.empty() ? 0 : pcsr_header::__weighted )
+                              | ( _M_directed ? pcsr_header::__directed : 0 );
+        __h._S_vertex_count = _M_vertex_count;
+        __h._S_edge_count   = __m;
+        __h._S_offsets      = __detail::csr_align( sizeof( pcsr_header ) );
+        __h._S_neighbors    = __detail::csr_align( __h._S_offsets
+                                + _M_offsets.size() * sizeof( __u64 ) );
+        __h._S_weights      = _M_weights.empty()
+                              ? 0
+                              : __detail::csr_align( __h._S_neighbors
+                                  + __m * sizeof( __u32 ) );
+
+        std::FILE*  __f = std::fopen( __path.c_str(), "wb" );
+        if( __f == nullptr )
+          { throw pexception( "E: Не удалось открыть файл для записи." ); }
+
+        __u64  __at{ 0 };
+        bool   __ok{ true };
+
+        /** Запись секции с дополнением нулями до ее смещения.
+         */
+        auto __put = [&]( __u64 __offset, const void* __data, __u64 __size )
+          {
+          static const char  __zero[pcsr_header::__align] = { };
+
+          if( __at < __offset )
+            { __ok = __ok && std::fwrite( __zero, 1, __offset - __at, __f )
+                             == __offset - __at; }
+          if( __size > 0 )
+            { __ok = __ok && std::fwrite( __data, 1, __size, __f ) == __size; }
+          __at = __offset + __size;
+          };
+
+        __put( 0, &__h, sizeof( __h ) );
+        __put( __h._S_offsets, _M_offsets.data(),
+               _M_offsets.size() * sizeof( __u64 ) );
+        __put( __h._S_neighbors, _M_neighbors.data(), __m * sizeof( __u32 ) );
+        if( !_M_weights.empty() )
+          { __put( __h._S_weights, _M_weights.data(), __m * sizeof( __u32 ) ); }
+
+        if( std::fclose( __f ) != 0 || !__ok )
+          { throw pexception( "E: Ошибка записи CSR-файла." ); }
+        }
+
+    }; // class pcsr_graph
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Отображение двоичного CSR-файла в память.
+   * Файл не разбирается и не копируется: view() указывает прямо в
+   * отображенные страницы.
+   *
+   * При открытии файл проверяется одним линейным проходом: смещения
+   * не убывают и не больше числа ребер, концы ребер - существующие
+   * вершины. Поэтому поврежденный или чужой файл отвергается
+   * исключением, а не приводит к чтению за границами массивов в
+   * обходах. Проход читает все секции, кроме весов, один раз.
+   */
+  class pcsr_file
+    {
+    private:
+      void*      _M_base{ MAP_FAILED };
+      __u64      _M_size{ 0 };
+      pcsr_view  _M_view;
+
+    public:
+      explicit
+      pcsr_file( const std::string& __path )
+        {
+        __detail::csr_check_endian();
+
+        int  __fd = ::open( __path.c_str(), O_RDONLY );
+        if( __fd < 0 )
+          { throw pexception( "E: Не удалось открыть CSR-файл." ); }
+
+        struct stat  __st;
+        if( ::fstat( __fd, &__st ) != 0
+            || static_cast<__u64>( __st.st_size ) < sizeof( pcsr_header ) )
+          {
+          ::close( __fd );
+          throw pexception( "E: Некорректный CSR-файл." );
+          }
+
+        _M_size = static_cast<__u64>( __st.st_size );
+        _M_base = ::mmap( nullptr, _M_size, PROT_READ, MAP_SHARED, __fd, 0 );
+        ::close( __fd );
+
+        if( _M_base == MAP_FAILED )
+          { throw pexception( "E: Не удалось отобразить CSR-файл." ); }
+
+        const char*         __p = static_cast<const char*>( _M_base );
+        const pcsr_header*  __h = reinterpret_cast<const pcsr_header*>( __p );
+
+        /** Проверка заголовка и границ секций до первого обращения
+         *  к массивам.
+         */
+        __u64  __n = __h->_S_vertex_count;
+        __u64  __m = __h->_S_edge_count;
+        bool   __weighted = ( __h->_S_flags & pcsr_header::__weighted ) != 0;
+
+        auto __fits = [&]( __u64 __offset, __u64 __bytes )
+          {
+          return __offset % pcsr_header::__align == 0
+                 && __offset <= _M_size
+                 && __bytes <= _M_size - __offset;
+          };
+
+        auto __reject = [&]()
+          {
+          ::munmap( _M_base, _M_size );
+          throw pexception( "E: Некорректный CSR-файл." );
+          };
+
+        if( __h->_S_magic != pcsr_header::__magic
+            || __h->_S_version != pcsr_header::__version
+            || __n >= 0xFFFFFFFFULL
+            || __m > _M_size
+            || !__fits( __h->_S_offsets, ( __n + 1 ) * sizeof( __u64 ) )
+            || !__fits( __h->_S_neighbors, __m * sizeof( __u32 ) )
+            || ( __weighted && !__fits( __h->_S_weights, __m * sizeof( __u32 ) ) ) )
+          { __reject(); }
+
+        const __u64*  __offsets =
+          reinterpret_cast<const __u64*>( __p + __h->_S_offsets );
+        const __u32*  __neighbors =
+          reinterpret_cast<const __u32*>( __p + __h->_S_neighbors );
+
+        /** Смещения: 0 = offsets[0] <= offsets[1] <= ... <= offsets[n] = m.
+         *  Концы ребер: neighbors[i] < n.
+         */
+        if( __offsets[0] != 0 || __offsets[__n] != __m )
+          { __reject(); }
+
+        for( __u64 __v{ 0 }; __v < __n; __v++ )
+          {
+          if( __offsets[__v] > __offsets[__v + 1] )
+            { __reject(); }
+          }
+
+        for( __u64 __i{ 0 }; __i < __m; __i++ )
+          {
+          if( __neighbors[__i] >= __n )
+            { __reject(); }
+          }
+
+        _M_view = pcsr_view(
+          static_cast<__u32>( __n ), __m, __offsets, __neighbors,
+          __weighted
+            ? reinterpret_cast<const __u32*>( __p + __h->_S_weights )
+            : nullptr );
+        }
+
+      pcsr_file( const pcsr_file& ) = delete;
+
+      pcsr_file&
+      operator=( const pcsr_file& ) = delete;
+
+      ~pcsr_file() noexcept
+        {
+        if( _M_base != MAP_FAILED )
+          { ::munmap( _M_base, _M_size ); }
+        }
+//--------------------------------------------------------------------
+      auto
+      view() const -> const pcsr_view&
+        { return _M_view; }
+//--------------------------------------------------------------------
+// Признак ориентированного (несимметризованного) графа.
+      auto
+      is_directed() const -> bool
+        {
+        return ( static_cast<const pcsr_header*>( _M_base )->_S_flags
+                 & pcsr_header::__directed ) != 0;
+        }
+
+    }; // class pcsr_file
+//--------------------------------------------------------------------
+// Преобразование текстового списка ребер в двоичный CSR-файл.
+// Строка файла: "откуда куда [вес]"; пустые строки и строки,
+// начинающиеся с '#' или '%', пропускаются. Количество вершин -
+// наибольший номер плюс один; pcsr_file принимает не больше
+// 0xFFFFFFFE вершин, поэтому номера больше 0xFFFFFFFD отвергаются.
+// Если хотя бы у одного ребра указан
+// вес, файл сохраняется со значениями весов (по умолчанию 1).
+  inline auto
+  csr_convert( const std::string& __text_path, const std::string& __csr_path,
+               bool __symmetric ) -> void
+    {
+    std::ifstream  __in( __text_path );
+    if( !__in )
+      { throw pexception( "E: Не удалось открыть список ребер." ); }
+
+    std::vector<pedge>  __edges;
+    std::string         __line;
+    __u64               __n{ 0 };
+    bool                __weighted{ false };
+
+    while( std::getline( __in, __line ) )
+      {
+      const char*  __s = __line.c_str();
+
+      while( *__s == ' ' || *__s == '\t' )
+        { __s++; }
+
+      if( *__s == '\0' || *__s == '\r' || *__s == '#' || *__s == '%' )
+        { continue; }
+
+      char*  __end{ nullptr };
+      __u64  __from = std::strtoull( __s, &__end, 10 );
+      if( __end == __s )
+        { throw pexception( "E: Некорректная строка списка ребер." ); }
+
+      __s = __end;
+      __u64  __to = std::strtoull( __s, &__end, 10 );
+      if( __end == __s )
+        { throw pexception( "E: Некорректная строка списка ребер." ); }
+
+      __s = __end;
+      __u64  __w = std::strtoull( __s, &__end, 10 );
+      if( __end != __s )
+        { __weighted = true; }
+      else
+        { __w = 1; }
+
+      if( __from >= 0xFFFFFFFEULL || __to >= 0xFFFFFFFEULL
+          || __w > 0xFFFFFFFFULL )
+        { throw pexception( "E: Значение в списке ребер слишком велико." ); }
+
+      __edges.push_back( { static_cast<__u32>( __from ),
+                           static_cast<__u32>( __to ),
+                           static_cast<__u32>( __w ) } );
+
+      if( __from + 1 > __n ) { __n = __from + 1; }
+      if( __to + 1 > __n )   { __n = __to + 1; }
+      }
+
+    pcsr_graph( static_cast<__u32>( __n ), __edges, __symmetric, __weighted )
+      .save( __csr_path );
+    }
+
+  } // namespace ptl
+
+#endif // __PTL_PCSR_H__
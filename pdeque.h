@@ -0,0 +1,329 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для двусторонней очереди.
+ */
+
+/**
+ *  (PTL) Patriarch library : pdeque.h
+ */
+
+#pragma once
+#if !defined( __PTL_PDEQUE_H__ )
+#define __PTL_PDEQUE_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#if !defined( __PTL_PEXCEPT_H__ )
+#include "pexcept.h"
+#endif
+
+#include <new>
+#include <utility>
+
+/*
+ * Двусторонняя очередь на растущем кольцевом буфере. Элементы лежат
+ * в одном непрерывном массиве емкостью степень двойки; вставка и
+ * извлечение с обоих концов - O(1) (амортизированно при росте),
+ * доступ по индексу - O(1).
+ *
+ * Содержимое кольца - не более двух непрерывных отрезков: от начала
+ * до конца массива и с начала массива. Обход через for_each_segment()
+ * получает эти отрезки как обычные массивы, поэтому циклы над ними
+ * компилятор может векторизовать; for_each() обходит их же.
+ *
+ * Методы:
+ *   - push_back(), push_front() - вставка в конец и в начало
+ *   - emplace_back(), emplace_front() - создание элемента на месте
+ *   - pop_back(), pop_front() - извлечение с конца и с начала
+ *     (элемент возвращается перемещением)
+ *   - front(), back() - ссылка на первый и последний элементы
+ *   - operator[]() - доступ по индексу без проверки
+ *   - at() - доступ по индексу с проверкой
+ *   - for_each_segment() - обход непрерывных отрезков f( data, n )
+ *   - for_each() - обход элементов от начала к концу
+ *   - size(), is_empty(), capacity(), reserve(), clear()
+ *
+ * @code
+ *   ptl::pdeque<ptl::__s32> deque;
+ *   deque.push_back( 1 );
+ *   deque.push_front( 0 );
+ *   ptl::__s32 x = deque.pop_front();
+ *   deque.for_each_segment( []( ptl::__s32* p, ptl::__u64 n )
+ *     { for( ptl::__u64 i = 0; i < n; i++ ) { p[i] *= 2; } } );
+ * @endcode
+ */
+
+namespace ptl
+  {
+//////////////////////////////////////////////////////////////////////
+  template <typename _Tp>
+  class pdeque
+    {
+    private:
+      _Tp*   _M_data{ nullptr };
+      __u64  _M_mask{ 0 };  // Емкость - 1 (емкость - степень двойки)
+      __u64  _M_head{ 0 };  // Позиция первого элемента в массиве
+      __u64  _M_size{ 0 };
+
+      auto
+      slot( __u64 __index ) const -> __u64
+        { return ( _M_head + __index ) & _M_mask; }
+//--------------------------------------------------------------------
+      // Перенос элементов в новый массив __data емкостью __capacity
+      // (степень двойки): элемент с номером i попадает в позицию
+      // __shift + i, начало очереди - позиция 0.
+      auto
+      relocate( _Tp* __data, __u64 __capacity, __u64 __shift ) -> void
+        {
+        for( __u64 __i{ 0 }; __i < _M_size; __i++ )
+          {
+          _Tp&  __x = _M_data[slot( __i )];
+          new( __data + __shift + __i ) _Tp( std::move( __x ) );
+          __x.~_Tp();
+          }
+
+        ::operator delete( _M_data );
+        _M_data = __data;
+        _M_mask = __capacity - 1;
+        _M_head = 0;
+        }
+//--------------------------------------------------------------------
+      auto
+      reallocate( __u64 __capacity ) -> void
+        {
+        relocate( static_cast<_Tp*>( ::operator new( __capacity * sizeof( _Tp ) ) ),
+                  __capacity, 0 );
+        }
+//--------------------------------------------------------------------
+      auto
+      is_full() const -> bool
+        { return _M_data == nullptr || _M_size == _M_mask + 1; }
+//--------------------------------------------------------------------
+      // Рост заполненной очереди вдвое со вставкой: элемент из __args
+      // создается в позиции __at нового массива, и только потом туда
+      // переносятся старые элементы со сдвигом __shift. Аргументы могут
+      // ссылаться на элементы самой очереди (d.push_back( d[0] )), и
+      // до переноса они еще целы. Если создание элемента выбросит
+      // исключение, очередь не меняется.
+      template <typename... _Args>
+        auto
+        grow_emplace( __u64 __at, __u64 __shift, _Args&&... __args ) -> _Tp*
+          {
+          __u64  __capacity = _M_data == nullptr ? 8 : ( _M_mask + 1 ) * 2;
+          _Tp*   __data = static_cast<_Tp*>( ::operator new( __capacity * sizeof( _Tp ) ) );
+
+          try
+            { new( __data + __at ) _Tp( std::forward<_Args>( __args )... ); }
+          catch( ... )
+            {
+            ::operator delete( __data );
+            throw;
+            }
+
+          relocate( __data, __capacity, __shift );
+          return __data + __at;
+          }
+//--------------------------------------------------------------------
+      auto
+      check_not_empty() const -> void
+        {
+        if( _M_size == 0 )
+          { throw pexception( "W: Очередь пуста." ); }
+        }
+
+    public:
+      pdeque() = default;
+
+      pdeque( const pdeque& ) = delete;
+
+      pdeque&
+      operator=( const pdeque& ) = delete;
+
+      ~pdeque() noexcept
+        {
+        clear();
+        ::operator delete( _M_data );
+        }
+//--------------------------------------------------------------------
+      auto
+      push_back( const _Tp& __data ) -> void
+        { emplace_back( __data ); }
+//--------------------------------------------------------------------
+      auto
+      push_back( _Tp&& __data ) -> void
+        { emplace_back( std::move( __data ) ); }
+//--------------------------------------------------------------------
+      auto
+      push_front( const _Tp& __data ) -> void
+        { emplace_front( __data ); }
+//--------------------------------------------------------------------
+      auto
+      push_front( _Tp&& __data ) -> void
+        { emplace_front( std::move( __data ) ); }
+//--------------------------------------------------------------------
+      template <typename... _Args>
+        auto
+        emplace_back( _Args&&... __args ) -> _Tp&
+          {
+          _Tp*  __p;
+
+          if( is_full() )
+            { __p = grow_emplace( _M_size, 0, std::forward<_Args>( __args )... ); }
+          else
+            { __p = new( _M_data + slot( _M_size ) ) _Tp( std::forward<_Args>( __args )... ); }
+          _M_size++;
+          return *__p;
+          }
+//--------------------------------------------------------------------
+      template <typename... _Args>
+        auto
+        emplace_front( _Args&&... __args ) -> _Tp&
+          {
+          _Tp*  __p;
+
+          if( is_full() )
+            { __p = grow_emplace( 0, 1, std::forward<_Args>( __args )... ); }
+          else
+            {
+            __u64  __at = ( _M_head - 1 ) & _M_mask;
+            __p = new( _M_data + __at ) _Tp( std::forward<_Args>( __args )... );
+            _M_head = __at;
+            }
+          _M_size++;
+          return *__p;
+          }
+//--------------------------------------------------------------------
+// Извлечение последнего элемента перемещением.
+      auto
+      pop_back() -> _Tp
+        {
+        check_not_empty();
+
+        _Tp&  __x = _M_data[slot( _M_size - 1 )];
+        _Tp   __result( std::move( __x ) );
+        __x.~_Tp();
+        _M_size--;
+        return __result;
+        }
+//--------------------------------------------------------------------
+// Извлечение первого элемента перемещением.
+      auto
+      pop_front() -> _Tp
+        {
+        check_not_empty();
+
+        _Tp&  __x = _M_data[_M_head];
+        _Tp   __result( std::move( __x ) );
+        __x.~_Tp();
+        _M_head = ( _M_head + 1 ) & _M_mask;
+        _M_size--;
+        return __result;
+        }
+//--------------------------------------------------------------------
+      auto
+      front() -> _Tp&
+        {
+        check_not_empty();
+        return _M_data[_M_head];
+        }
+//--------------------------------------------------------------------
+      auto
+      back() -> _Tp&
+        {
+        check_not_empty();
+        return _M_data[slot( _M_size - 1 )];
+        }
+//--------------------------------------------------------------------
+      auto
+      operator[]( __u64 __index ) -> _Tp&
+        { return _M_data[slot( __index )]; }
+//--------------------------------------------------------------------
+      auto
+      operator[]( __u64 __index ) const -> const _Tp&
+        { return _M_data[slot( __index )]; }
+//--------------------------------------------------------------------
+      auto
+      at( __u64 __index ) -> _Tp&
+        {
+        if( __index >= _M_size )
+          { throw pexception( "E: Индекс вне диапазона." ); }
+        return _M_data[slot( __index )];
+        }
+//--------------------------------------------------------------------
+// Вызов __f( data, n ) для каждого непрерывного отрезка содержимого
+// (не более двух) в порядке от начала к концу.
+      template <typename _Func>
+        auto
+        for_each_segment( _Func __f ) -> void
+          {
+          if( _M_size == 0 )
+            { return; }
+
+          __u64  __first = _M_mask + 1 - _M_head;
+          if( __first >= _M_size )
+            {
+            __f( _M_data + _M_head, _M_size );
+            return;
+            }
+
+          __f( _M_data + _M_head, __first );
+          __f( _M_data, _M_size - __first );
+          }
+//--------------------------------------------------------------------
+// Вызов __f( element ) для каждого элемента от начала к концу.
+      template <typename _Func>
+        auto
+        for_each( _Func __f ) -> void
+          {
+          for_each_segment( [&]( _Tp* __p, __u64 __n )
+            {
+            for( __u64 __i{ 0 }; __i < __n; __i++ )
+              { __f( __p[__i] ); }
+            } );
+          }
+//--------------------------------------------------------------------
+      auto
+      size() const -> __u64
+        { return _M_size; }
+//--------------------------------------------------------------------
+      auto
+      is_empty() const -> bool
+        { return _M_size == 0; }
+//--------------------------------------------------------------------
+      auto
+      capacity() const -> __u64
+        { return _M_data == nullptr ? 0 : _M_mask + 1; }
+//--------------------------------------------------------------------
+// Резервирование места не меньше чем под __count элементов.
+      auto
+      reserve( __u64 __count ) -> void
+        {
+        if( __count <= capacity() )
+          { return; }
+
+        __u64  __capacity{ 8 };
+        while( __capacity < __count )
+          { __capacity <<= 1; }
+        reallocate( __capacity );
+        }
+//--------------------------------------------------------------------
+// Удаление всех элементов; память сохраняется.
+      auto
+      clear() -> void
+        {
+        for( __u64 __i{ 0 }; __i < _M_size; __i++ )
+          { _M_data[slot( __i )].~_Tp(); }
+        _M_head = 0;
+        _M_size = 0;
+        }
+
+    }; // class pdeque
+
+  } // namespace ptl
+
+#endif // __PTL_PDEQUE_H__
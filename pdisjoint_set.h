@@ -0,0 +1,156 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для системы непересекающихся множеств.
+ */
+
+/**
+ *  (PTL) Patriarch library : pdisjoint_set.h
+ */
+
+#pragma once
+#if !defined( __PTL_PDISJOINT_SET_H__ )
+#define __PTL_PDISJOINT_SET_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#if !defined( __PTL_PEXCEPT_H__ )
+#include "pexcept.h"
+#endif
+
+#include <vector>
+
+/*
+ * Система непересекающихся множеств (union-find).
+ * Объединение по рангу и сокращение пути делением пополам дают
+ * почти константное амортизированное время операций.
+ *
+ * Методы:
+ *   - add() - добавление нового одноэлементного множества
+ *   - resize() - расширение до заданного количества элементов
+ *   - find() - представитель множества элемента
+ *   - unite() - объединение множеств двух элементов
+ *   - same() - проверка, лежат ли элементы в одном множестве
+ *   - size() - количество элементов
+ *   - set_count() - количество множеств
+ *
+ * @code
+ *   ptl::pdisjoint_set ds( 10 );
+ *   ds.unite( 1, 2 );
+ *   bool joined = ds.same( 1, 2 );
+ * @endcode
+ */
+
+namespace ptl
+  {
+//////////////////////////////////////////////////////////////////////
+  class pdisjoint_set
+    {
+    private:
+      std::vector<__u32>  _M_parent;         // Родитель элемента
+      std::vector<__u8>   _M_rank;           // Ранг корня (оценка высоты)
+      __u32               _M_set_count{ 0 }; // Количество множеств
+
+    public:
+      explicit
+      pdisjoint_set( __u32 __size = 0 )
+        { resize( __size ); }
+
+      ~pdisjoint_set() noexcept
+        { }
+//--------------------------------------------------------------------
+// Добавление нового одноэлементного множества.
+// Возвращает номер добавленного элемента.
+      auto
+      add() -> __u32
+        {
+        __u32  __x = size();
+
+        _M_parent.push_back( __x );
+        _M_rank.push_back( 0 );
+        _M_set_count++;
+
+        return __x;
+        }
+//--------------------------------------------------------------------
+// Расширение до __size элементов; новые элементы - одноэлементные
+// множества. Уменьшение размера не допускается.
+      auto
+      resize( __u32 __size ) -> void
+        {
+        if( __size < size() )
+          { throw pexception( "E: Уменьшение системы множеств не допускается." ); }
+
+        _M_parent.reserve( __size );
+        _M_rank.reserve( __size );
+
+        while( size() < __size )
+          { add(); }
+        }
+//--------------------------------------------------------------------
+// Представитель множества элемента.
+// Деление пути пополам: каждый пройденный узел перевешивается на
+// своего деда, что сокращает путь без второго прохода.
+      auto
+      find( __u32 __x ) -> __u32
+        {
+        while( _M_parent[__x] != __x )
+          {
+          _M_parent[__x] = _M_parent[_M_parent[__x]];
+          __x = _M_parent[__x];
+          }
+        return __x;
+        }
+//--------------------------------------------------------------------
+// Объединение множеств двух элементов.
+// true  - множества были разными и объединены.
+// false - элементы уже лежали в одном множестве.
+      auto
+      unite( __u32 __a, __u32 __b ) -> bool
+        {
+        __a = find( __a );
+        __b = find( __b );
+
+        if( __a == __b )
+          { return false; }
+
+        /** Меньшее по рангу дерево подвешивается к большему.
+         */
+        if( _M_rank[__a] < _M_rank[__b] )
+          {
+          __u32  __t = __a;
+          __a = __b;
+          __b = __t;
+          }
+
+        _M_parent[__b] = __a;
+        if( _M_rank[__a] == _M_rank[__b] )
+          { _M_rank[__a]++; }
+
+        _M_set_count--;
+        return true;
+        }
+//--------------------------------------------------------------------
+// Проверка, лежат ли элементы в одном множестве.
+      auto
+      same( __u32 __a, __u32 __b ) -> bool
+        { return find( __a ) == find( __b ); }
+//--------------------------------------------------------------------
+// Количество элементов.
+      auto
+      size() const -> __u32
+        { return static_cast<__u32>( _M_parent.size() ); }
+//--------------------------------------------------------------------
+// Количество множеств.
+      auto
+      set_count() const -> __u32
+        { return _M_set_count; }
+
+    }; // class pdisjoint_set
+  } // namespace ptl
+
+#endif // __PTL_PDISJOINT_SET_H__
@@ -0,0 +1,330 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для изменяемого графа на списках смежности.
+ */
+
+/**
+ *  (PTL) Patriarch library : pdyngraph.h
+ */
+
+#pragma once
+#if !defined( __PTL_PDYNGRAPH_H__ )
+#define __PTL_PDYNGRAPH_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#if !defined( __PTL_PEXCEPT_H__ )
+#include "pexcept.h"
+#endif
+
+#if !defined( __PTL_PCSR_H__ )
+#include "pcsr.h"
+#endif
+
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Неориентированный взвешенный граф для потока изменений: вставка
+ * и удаление ребра - O(1) в среднем, удаление вершины - O(степень).
+ *
+ * Ребро хранится дугами в обоих списках смежности. Позиция каждой
+ * дуги в списке записана в хеш-таблице, поэтому удаление - обмен с
+ * последним элементом списка и исправление позиции перенесенной дуги.
+ * Номер удаленной вершины становится "надгробием" и выдается заново
+ * следующему add_vertex(). Для фаз, где граф только читается, его
+ * можно уплотнить в pcsr_graph.
+ *
+ * Методы:
+ *   - add_vertex() - добавление вершины, возвращает ее номер
+ *   - del_vertex() - удаление вершины вместе с ее ребрами
+ *   - is_exists_vertex() - проверка существования вершины
+ *   - add_edge() - добавление ребра или изменение его веса
+ *   - del_edge() - удаление ребра
+ *   - is_exists_edge() - проверка существования ребра
+ *   - weight() - вес ребра
+ *   - degree() - степень вершины
+ *   - vertex_count() - количество живых вершин
+ *   - edge_count() - количество ребер
+ *   - tombstone_count() - количество свободных номеров вершин
+ *   - vertex_bound(), adj_begin(), adj_end(), adj_next(), adj_target(),
+ *     adj_weight() - курсоры смежности для алгоритмов из ptraversal.h
+ *   - to_csr() - снимок в CSR с сохранением номеров вершин
+ *   - to_csr_dense() - снимок в CSR с плотной перенумерацией вершин
+ *
+ * @code
+ *   ptl::pdyngraph  g;
+ *   ptl::__u32 a = g.add_vertex();
+ *   ptl::__u32 b = g.add_vertex();
+ *   g.add_edge( a, b, 5 );
+ *   g.del_vertex( a );
+ *   ptl::pcsr_graph snapshot = g.to_csr();
+ * @endcode
+ */
+
+namespace ptl
+  {
+//////////////////////////////////////////////////////////////////////
+  class pdyngraph
+    {
+    private:
+      struct _Arc
+        {
+        __u32  _S_to;
+        __u32  _S_weight;
+        };
+
+      std::vector<std::vector<_Arc>>    _M_adj;   // Списки смежности
+      std::vector<__u8>                 _M_alive; // 1 - вершина существует
+      std::vector<__u32>                _M_free;  // Номера удаленных вершин
+      std::unordered_map<__u64, __u32>  _M_pos;   // Дуга -> позиция в списке
+      __u64                             _M_edge_count{ 0 };
+
+      static auto
+      key( __u32 __from, __u32 __to ) -> __u64
+        { return ( static_cast<__u64>( __from ) << 32 ) | __to; }
+//--------------------------------------------------------------------
+      auto
+      check_vertex( __u32 __v ) const -> void
+        {
+        if( __v >= _M_adj.size() || !_M_alive[__v] )
+          { throw pexception( "E: Такой вершины в графе нет." ); }
+        }
+//--------------------------------------------------------------------
+      // Удаление дуги __from -> __to обменом с последней дугой списка.
+      auto
+      erase_arc( __u32 __from, __u32 __to ) -> void
+        {
+        auto  __it = _M_pos.find( key( __from, __to ) );
+        __u32               __i    = __it->second;
+        std::vector<_Arc>&  __list = _M_adj[__from];
+
+        _M_pos.erase( __it );
+
+        if( __i + 1 != __list.size() )
+          {
+          __list[__i] = __list.back();
+          _M_pos[key( __from, __list[__i]._S_to )] = __i;
+          }
+        __list.pop_back();
+        }
+
+    public:
+      pdyngraph() = default;
+
+      /** Граф из __vertex_count вершин без ребер.
+       */
+      explicit
+      pdyngraph( __u32 __vertex_count )
+        : _M_adj( __vertex_count ), _M_alive( __vertex_count, 1 )
+        { }
+
+      ~pdyngraph() noexcept
+        { }
+//--------------------------------------------------------------------
+// Добавление вершины. Сначала используются номера удаленных вершин.
+      auto
+      add_vertex() -> __u32
+        {
+        if( !_M_free.empty() )
+          {
+          __u32  __v = _M_free.back();
+          _M_free.pop_back();
+          _M_alive[__v] = 1;
+          return __v;
+          }
+
+        _M_adj.emplace_back();
+        _M_alive.push_back( 1 );
+        return static_cast<__u32>( _M_adj.size() - 1 );
+        }
+//--------------------------------------------------------------------
+// Удаление вершины и всех ее ребер за O(степень).
+      auto
+      del_vertex( __u32 __v ) -> void
+        {
+        check_vertex( __v );
+
+        for( const _Arc& __a : _M_adj[__v] )
+          {
+          erase_arc( __a._S_to, __v );
+          _M_pos.erase( key( __v, __a._S_to ) );
+          }
+
+        _M_edge_count -= _M_adj[__v].size();
+
+        /** Память списка освобождается: надгробие может долго
+         *  оставаться свободным.
+         */
+        std::vector<_Arc>().swap( _M_adj[__v] );
+        _M_alive[__v] = 0;
+        _M_free.push_back( __v );
+        }
+//--------------------------------------------------------------------
+// Проверка существования вершины.
+      auto
+      is_exists_vertex( __u32 __v ) const -> bool
+        { return __v < _M_adj.size() && _M_alive[__v]; }
+//--------------------------------------------------------------------
+// Добавление ребра. Для существующего ребра меняется вес.
+// true - ребро добавлено, false - ребро уже было.
+      auto
+      add_edge( __u32 __v1, __u32 __v2, __u32 __weight = 1 ) -> bool
+        {
+        check_vertex( __v1 );
+        check_vertex( __v2 );
+
+        if( __v1 == __v2 )
+          { throw pexception( "E: Петли в графе не поддерживаются." ); }
+
+        auto  __it = _M_pos.find( key( __v1, __v2 ) );
+        if( __it != _M_pos.end() )
+          {
+          _M_adj[__v1][__it->second]._S_weight = __weight;
+          _M_adj[__v2][_M_pos[key( __v2, __v1 )]]._S_weight = __weight;
+          return false;
+          }
+
+        _M_pos.emplace( key( __v1, __v2 ), static_cast<__u32>( _M_adj[__v1].size() ) );
+        _M_pos.emplace( key( __v2, __v1 ), static_cast<__u32>( _M_adj[__v2].size() ) );
+        _M_adj[__v1].push_back( { __v2, __weight } );
+        _M_adj[__v2].push_back( { __v1, __weight } );
+        _M_edge_count++;
+        return true;
+        }
+//--------------------------------------------------------------------
+// Удаление ребра. true - ребро было удалено.
+      auto
+      del_edge( __u32 __v1, __u32 __v2 ) -> bool
+        {
+        check_vertex( __v1 );
+        check_vertex( __v2 );
+
+        if( _M_pos.find( key( __v1, __v2 ) ) == _M_pos.end() )
+          { return false; }
+
+        erase_arc( __v1, __v2 );
+        erase_arc( __v2, __v1 );
+        _M_edge_count--;
+        return true;
+        }
+//--------------------------------------------------------------------
+// Проверка существования ребра.
+      auto
+      is_exists_edge( __u32 __v1, __u32 __v2 ) const -> bool
+        { return _M_pos.find( key( __v1, __v2 ) ) != _M_pos.end(); }
+//--------------------------------------------------------------------
+// Вес ребра.
+      auto
+      weight( __u32 __v1, __u32 __v2 ) const -> __u32
+        {
+        auto  __it = _M_pos.find( key( __v1, __v2 ) );
+        if( __it == _M_pos.end() )
+          { throw pexception( "E: Такого ребра в графе нет." ); }
+        return _M_adj[__v1][__it->second]._S_weight;
+        }
+//--------------------------------------------------------------------
+      auto
+      degree( __u32 __v ) const -> __u32
+        { return static_cast<__u32>( _M_adj[__v].size() ); }
+//--------------------------------------------------------------------
+      auto
+      vertex_count() const -> __u32
+        { return static_cast<__u32>( _M_adj.size() - _M_free.size() ); }
+//--------------------------------------------------------------------
+      auto
+      edge_count() const -> __u64
+        { return _M_edge_count; }
+//--------------------------------------------------------------------
+// Количество свободных номеров. Когда их доля велика, стоит
+// перейти на снимок to_csr_dense().
+      auto
+      tombstone_count() const -> __u32
+        { return static_cast<__u32>( _M_free.size() ); }
+//--------------------------------------------------------------------
+// Верхняя граница номеров вершин. У удаленных вершин нет ребер.
+      auto
+      vertex_bound() const -> __u32
+        { return static_cast<__u32>( _M_adj.size() ); }
+//--------------------------------------------------------------------
+      auto
+      adj_begin( __u32 ) const -> __u32
+        { return 0; }
+//--------------------------------------------------------------------
+      auto
+      adj_end( __u32 __v ) const -> __u32
+        { return static_cast<__u32>( _M_adj[__v].size() ); }
+//--------------------------------------------------------------------
+      auto
+      adj_next( __u32, __u32 __c ) const -> __u32
+        { return __c + 1; }
+//--------------------------------------------------------------------
+      auto
+      adj_target( __u32 __v, __u32 __c ) const -> __u32
+        { return _M_adj[__v][__c]._S_to; }
+//--------------------------------------------------------------------
+      auto
+      adj_weight( __u32 __v, __u32 __c ) const -> __u32
+        { return _M_adj[__v][__c]._S_weight; }
+//--------------------------------------------------------------------
+// Снимок графа в CSR. Номера вершин сохраняются, удаленные вершины
+// остаются изолированными.
+      auto
+      to_csr() const -> pcsr_graph
+        {
+        std::vector<pedge>  __edges;
+        __edges.reserve( _M_edge_count );
+
+        for( __u32 __v{ 0 }; __v < _M_adj.size(); __v++ )
+          {
+          for( const _Arc& __a : _M_adj[__v] )
+            {
+            if( __v < __a._S_to )
+              { __edges.push_back( { __v, __a._S_to, __a._S_weight } ); }
+            }
+          }
+
+        return pcsr_graph( vertex_bound(), __edges, true, true );
+        }
+//--------------------------------------------------------------------
+// Снимок графа в CSR с плотными номерами 0..vertex_count()-1 в
+// порядке возрастания старых номеров. __ids[новый] = старый номер.
+      auto
+      to_csr_dense( std::vector<__u32>& __ids ) const -> pcsr_graph
+        {
+        std::vector<__u32>  __remap( _M_adj.size(), 0 );
+        std::vector<pedge>  __edges;
+
+        __ids.clear();
+        for( __u32 __v{ 0 }; __v < _M_adj.size(); __v++ )
+          {
+          if( _M_alive[__v] )
+            {
+            __remap[__v] = static_cast<__u32>( __ids.size() );
+            __ids.push_back( __v );
+            }
+          }
+
+        __edges.reserve( _M_edge_count );
+        for( __u32 __v : __ids )
+          {
+          for( const _Arc& __a : _M_adj[__v] )
+            {
+            if( __v < __a._S_to )
+              { __edges.push_back( { __remap[__v], __remap[__a._S_to], __a._S_weight } ); }
+            }
+          }
+
+        return pcsr_graph( static_cast<__u32>( __ids.size() ), __edges, true, true );
+        }
+
+    }; // class pdyngraph
+
+  } // namespace ptl
+
+#endif // __PTL_PDYNGRAPH_H__
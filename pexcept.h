@@ -57,6 +57,10 @@ namespace ptl
       const char*  _M_message{ }; // Сообщение для исключения
     };
 
+  // Псевдоним, под которым исключение бросается в остальных
+  // модулях библиотеки.
+  typedef pException  pexception;
+
   } // namespace ptl
 
 #endif // __PTL_PEXCEPT_H__
\ No newline at end of file
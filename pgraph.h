@@ -22,6 +22,14 @@
 #include "pexcept.h"
 #endif
 
+#if !defined( __PTL_PTRAVERSAL_H__ )
+#include "ptraversal.h"
+#endif
+
+#if !defined( __PTL_PPRIORITY_QUEUE_H__ )
+#include "ppriority_queue.h"
+#endif
+
 #include <iostream>
 
 /*
@@ -35,6 +43,9 @@
  *   - del_vertex() - удаление вершины графа
  *   - del_edge() - удаление ребра графа
  *   - size() - размер графа
+ *   - vertex_bound() - верхняя граница номеров вершин графа
+ *   - adj_begin(), adj_end(), adj_next(), adj_target(), adj_weight() -
+ *     курсоры смежности для алгоритмов из ptraversal.h
  *   - depth() - обход графа в глубину
  *   - width() - обход графа в ширину
  *   - count_paths() - поиск количества всех возможных путей
@@ -59,23 +70,14 @@ namespace ptl
       __u32  _M_vertexes[SIZE];     // Хранилище вершин
       __u32  _M_vertex_count;       // Количество добавленных вершин
 
+//--------------------------------------------------------------------
+      // Поиск первого ребра вершины __v, начиная со столбца __from.
       auto
-      depth_dfs( __u32 __current, bool __visited[] ) -> void
+      adj_scan( __u32 __v, __u32 __from ) const -> __u32
         {
-        std::cout << "v"
-                  << __current
-                  << " -> ";
-
-        __visited[__current] = true; // Помечаем как посещенную.
-
-        for( __u32 __i{ 0 }; __i < SIZE; __i++ )
-          {
-          if( is_exists_edge( __current, __i ) && !__visited[__i] )
-            /** Если существует ребро и вершина не посещаласть,
-             *  то пройдем по нему в смежную вершину.
-             */
-            { depth_dfs( __i, __visited ); }
-          }
+        while( __from < SIZE && _M_matrix[__v][__from] == 0 )
+          { __from++; }
+        return __from;
         }
 //--------------------------------------------------------------------
       auto
@@ -106,6 +108,19 @@ namespace ptl
         return __count;
         }
 
+      /*
+       * Посетитель, выводящий вершины в порядке обхода.
+       */
+      struct print_visitor : pdfs_visitor
+        {
+        void discover_vertex( __u32 __v )
+          {
+          std::cout << "v"
+                    << __v
+                    << " -> ";
+          }
+        };
+
     public:
       pgraph() 
         {
@@ -162,31 +177,30 @@ namespace ptl
         if( !is_exists_vertex( __vnumber ) )
           { throw pexception("E: Такой вершины в графе нет."); }
 
-        /** Обнуляем столбец и строку матрицы.
+        if( __vnumber >= SIZE )
+          { throw pexception("E: Номер вершины вне матрицы смежности."); }
+
+        /** Обнуляем столбец и строку матрицы целиком: номера
+         *  вершин не обязаны быть меньше количества вершин.
          */
-        for( __u32 __i{ 0 }; __i < _M_vertex_count; __i++ )
+        for( __u32 __i{ 0 }; __i < SIZE; __i++ )
           {
           _M_matrix[__i][__vnumber] = 0;
           _M_matrix[__vnumber][__i] = 0;
           }
 
-        /** Удаляем вершину из списка вершин.
+        /** Удаляем вершину из списка вершин со сдвигом остальных:
+         *  порядок списка определяет порядок вывода результатов.
+         *  Вершина есть в списке - это проверено выше.
          */
-        __s32  __index{ -1 };
+        __u32  __index{ 0 };
 
-        for( __s32 __i{ 0 }; 
-             __i < static_cast<__s32>( _M_vertex_count ); 
-             __i++ )
-          {
-          if( _M_vertexes[__i] == __vnumber )
-            { __index = __i; }
-          }
+        while( _M_vertexes[__index] != __vnumber )
+          { __index++; }
 
         --_M_vertex_count;
 
-        for( __s32 __i{ __index }; 
-             __i < static_cast<__s32>( _M_vertex_count ); 
-             __i++ )
+        for( __u32 __i{ __index }; __i < _M_vertex_count; __i++ )
           { _M_vertexes[__i] = _M_vertexes[__i+1]; }
         }
 //--------------------------------------------------------------------
@@ -194,6 +208,9 @@ namespace ptl
       auto
       del_edge( __u32 __v1, __u32 __v2 ) -> void
         {
+        if( __v1 >= SIZE || __v2 >= SIZE )
+          { throw pexception("E: Номер вершины вне матрицы смежности."); }
+
         _M_matrix[__v1][__v2] = 0;
         _M_matrix[__v2][__v1] = 0;
         }
@@ -203,17 +220,43 @@ namespace ptl
       size() -> __u32
         { return ( _M_vertex_count - 1 ); }
 //--------------------------------------------------------------------
+// Верхняя граница номеров вершин графа.
+// Номера вершин совпадают с индексами матрицы смежности.
+      auto
+      vertex_bound() const -> __u32
+        { return SIZE; }
+//--------------------------------------------------------------------
+// Курсор первого ребра вершины __v.
+      auto
+      adj_begin( __u32 __v ) const -> __u32
+        { return adj_scan( __v, 0 ); }
+//--------------------------------------------------------------------
+// Курсор за последним ребром вершины __v.
+      auto
+      adj_end( __u32 ) const -> __u32
+        { return SIZE; }
+//--------------------------------------------------------------------
+// Курсор ребра, следующего за __c.
+      auto
+      adj_next( __u32 __v, __u32 __c ) const -> __u32
+        { return adj_scan( __v, __c + 1 ); }
+//--------------------------------------------------------------------
+// Вершина, в которую ведет ребро __c.
+      auto
+      adj_target( __u32, __u32 __c ) const -> __u32
+        { return __c; }
+//--------------------------------------------------------------------
+// Вес ребра __c.
+      auto
+      adj_weight( __u32 __v, __u32 __c ) const -> __u32
+        { return _M_matrix[__v][__c]; }
+//--------------------------------------------------------------------
 // Обход графа в глубину.
       auto
       depth( __u32 __start ) -> void
         {
-        bool  __visited[SIZE]; // Список посещенных вершин.
-
-        // Инициализируем как не посещенные.
-        for( __u32 __i{ 0 }; __i < SIZE; __i++ )
-          { __visited[__i] = false; }
-
-        depth_dfs( __start, __visited ); // Запуск алгоритма.
+        print_visitor  __vis;
+        dfs( *this, __start, __vis );
         }
 //--------------------------------------------------------------------
 // Обход графа в ширину.
@@ -302,12 +345,14 @@ namespace ptl
         for( __u32  __i{0}; __i < SIZE; __i++ )
           { __passed[__i] = false; }
 
-        // Принимаем стартовую вершину за текущую.
-        __u32  __current_vertex_num = __from_vert;
-        __u32  __min_dist           = 0;
+        // Неокрашенные вершины с конечной меткой, по возрастанию метки.
+        pindexed_priority_queue<__u32>  __queue( SIZE );
+        __queue.push( __from_vert, 0 );
 
-        while( __min_dist != VERYBIGINT )
+        while( !__queue.empty() )
           {
+          // Новая текущая вершина - с наименьшей меткой.
+          __u32  __current_vertex_num = __queue.pop();
           __passed[__current_vertex_num] = true; // Окрашиваем текущую.
 
           for( __u32  __i{0}; __i < SIZE; __i++ )
@@ -320,20 +365,14 @@ namespace ptl
               { 
               __distances[__i] = __distances[__current_vertex_num]
                                  + _M_matrix[__current_vertex_num][__i];
-              }
-            }
 
-          __min_dist = VERYBIGINT;
-
-          for( __u32  __i{0}; __i < SIZE; __i++ )
-            {
-            // Выбираем новую текущую вершину.
-            if( is_exists_vertex( __i )
-                && !__passed[__i]
-                && __distances[__i] < __min_dist )
-              {
-              __min_dist           = __distances[__i];
-              __current_vertex_num = __i;
+              if( is_exists_vertex( __i ) && !__passed[__i] )
+                {
+                if( __queue.contains( __i ) )
+                  { __queue.decrease_key( __i, __distances[__i] ); }
+                else
+                  { __queue.push( __i, __distances[__i] ); }
+                }
               }
             }
           }
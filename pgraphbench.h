@@ -0,0 +1,524 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для измерения производительности алгоритмов
+ * на графах.
+ */
+
+/**
+ *  (PTL) Patriarch library : pgraphbench.h
+ */
+
+#pragma once
+#if !defined( __PTL_PGRAPHBENCH_H__ )
+#define __PTL_PGRAPHBENCH_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#if !defined( __PTL_PEXCEPT_H__ )
+#include "pexcept.h"
+#endif
+
+#if !defined( __PTL_PBENCH_H__ )
+#include "pbench.h"
+#endif
+
+#if !defined( __PTL_PCSR_H__ )
+#include "pcsr.h"
+#endif
+
+#if !defined( __PTL_PGRAPHGEN_H__ )
+#include "pgraphgen.h"
+#endif
+
+#if !defined( __PTL_PTRAVERSAL_H__ )
+#include "ptraversal.h"
+#endif
+
+#if !defined( __PTL_PSSSP_H__ )
+#include "psssp.h"
+#endif
+
+#if !defined( __PTL_PSEARCH_H__ )
+#include "psearch.h"
+#endif
+
+#if !defined( __PTL_PCOMPONENTS_H__ )
+#include "pcomponents.h"
+#endif
+
+#if !defined( __PTL_PPARALLEL_H__ )
+#include "pparallel.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * Набор замеров для алгоритмов на графах. Каждая фаза дает запись:
+ * граф, фаза, размер, время, ребер в секунду и пиковый объем
+ * резидентной памяти за фазу. Записи выводятся в CSV или JSON для
+ * сравнения между версиями.
+ *
+ * Пик за фазу измеряется reset_peak_rss() и peak_rss_kb() из
+ * pbench.h. Если сброс пика недоступен, записывается пик процесса с
+ * его запуска, и у записи сброшен признак _S_phase_rss: тогда фазы
+ * после самой большой повторяют ее пик.
+ *
+ * Фазы на каждом графе: bfs, dfs, dijkstra, delta_stepping_<t>, apsp,
+ * components, components_parallel. delta_stepping_<t> - параллельный
+ * алгоритм на t потоках (по умолчанию 1, 8 и 32) с шириной корзины,
+ * равной среднему весу ребра; его результат сверяется с dijkstra(),
+ * расхождение - исключение, а в запись заносится ускорение
+ * относительно последовательного dijkstra(). APSP на больших графах выполняется по выборке
+ * из apsp_sources источников (алгоритм Дейкстры из каждого,
+ * параллельно по источникам); если источников не меньше числа
+ * вершин - полный APSP.
+ *
+ * Фазы поиска пути на решетке (run_search()): одни и те же случайные
+ * пары вершин ищутся astar_zero (A* с нулевой эвристикой - Дейкстра
+ * с остановкой на цели), astar_euclid (евклидова эвристика по
+ * координатам решетки) и bidirectional. Для них в запись заносятся
+ * среднее число обработанных вершин на запрос и процентили задержки
+ * одного запроса; стоимости путей сверяются между фазами.
+ *
+ * Классы:
+ *   - pbench_record - результат одной фазы
+ *   - pgraph_bench - выполнение фаз и вывод результатов
+ *
+ * Функции:
+ *   - run_graph_benchmarks() - полный прогон по всем генераторам
+ *     из pgraphgen.h для заданных масштабов
+ *
+ * @code
+ *   int main()
+ *     {
+ *     ptl::run_graph_benchmarks( std::cout, { 14, 16, 18 }, false );
+ *     return 0;
+ *     }
+ * @endcode
+ */
+
+namespace ptl
+  {
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Результат одной фазы замера.
+   */
+  struct pbench_record
+    {
+    std::string  _S_graph;             // имя графа
+    std::string  _S_phase;             // имя фазы
+    __u32        _S_vertices{ 0 };     // вершин в графе
+    __u64        _S_edges{ 0 };        // обработано ребер за фазу
+    double       _S_seconds{ 0.0 };    // время фазы
+    double       _S_edges_per_second{ 0.0 };
+    __u64        _S_peak_rss_kb{ 0 };  // пик резидентной памяти за фазу
+    bool         _S_phase_rss{ false }; // false - пик процесса с запуска
+    double       _S_speedup{ 0.0 };    // ускорение относительно базовой
+                                       // фазы (0 - не сравнивается)
+    double       _S_settled{ 0.0 };    // обработано вершин на запрос
+    // Задержка одного запроса: медиана, 90-й и 99-й процентили
+    // (0 - фаза не из запросов).
+    double       _S_p50_seconds{ 0.0 };
+    double       _S_p90_seconds{ 0.0 };
+    double       _S_p99_seconds{ 0.0 };
+    };
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Выполнение фаз замера и накопление записей.
+   *
+   * Методы:
+   *   - measure() - замер произвольной фазы
+   *   - measure_queries() - замер фазы из отдельных запросов
+   *   - run() - все фазы на одном CSR-графе
+   *   - run_search() - фазы поиска пути на решетке
+   *   - records() - накопленные записи
+   *   - write_csv() - вывод записей в CSV
+   *   - write_json() - вывод записей в JSON
+   */
+  class pgraph_bench
+    {
+    private:
+      std::vector<pbench_record>  _M_records;
+      __u32                       _M_threads;
+      __u32                       _M_apsp_sources;
+      std::vector<__u32>          _M_sssp_threads;  // Потоки delta_stepping_<t>
+      __u64                       _M_checksum{ 0 }; // Результаты фаз, чтобы
+                                                    // их не удалил оптимизатор
+
+      // Средний вес ребра, не меньше 1 - ширина корзины delta-stepping.
+      static auto
+      mean_weight( const pcsr_view& __g ) -> __u64
+        {
+        __u64  __m = __g.edge_count();
+        if( __m == 0 || !__g.is_weighted() )
+          { return 1; }
+
+        __u64  __sum{ 0 };
+        for( __u64 __i{ 0 }; __i < __m; __i++ )
+          { __sum += __g.weights()[__i]; }
+        return __sum / __m > 0 ? __sum / __m : 1;
+        }
+
+    public:
+      explicit
+      pgraph_bench( __u32 __threads = hardware_threads(),
+                    __u32 __apsp_sources = 16,
+                    std::vector<__u32> __sssp_threads = { 1, 8, 32 } )
+        : _M_threads( __threads ), _M_apsp_sources( __apsp_sources ),
+          _M_sssp_threads( std::move( __sssp_threads ) )
+        { }
+//--------------------------------------------------------------------
+// Замер фазы __f(), обработавшей __edges ребер. Возвращает время.
+      template <typename _Func>
+        auto
+        measure( const std::string& __graph, const std::string& __phase,
+                 __u32 __vertices, __u64 __edges, _Func __f ) -> double
+          {
+          bool  __reset = reset_peak_rss();
+
+          auto  __start = std::chrono::steady_clock::now();
+          _M_checksum += __f();
+          auto  __stop = std::chrono::steady_clock::now();
+
+          pbench_record  __r;
+          __r._S_graph       = __graph;
+          __r._S_phase       = __phase;
+          __r._S_vertices    = __vertices;
+          __r._S_edges       = __edges;
+          __r._S_seconds     = std::chrono::duration<double>( __stop - __start ).count();
+          __r._S_peak_rss_kb = peak_rss_kb();
+          __r._S_phase_rss   = __reset;
+          if( __r._S_seconds > 0.0 )
+            { __r._S_edges_per_second = static_cast<double>( __edges ) / __r._S_seconds; }
+
+          _M_records.push_back( __r );
+          return __r._S_seconds;
+          }
+//--------------------------------------------------------------------
+// Замер фазы из __count запросов __f( i ); запрос возвращает число
+// обработанных вершин. Кроме общего времени записываются среднее
+// число обработанных вершин и процентили задержки запроса.
+      template <typename _Func>
+        auto
+        measure_queries( const std::string& __graph, const std::string& __phase,
+                         __u32 __vertices, __u32 __count, _Func __f ) -> double
+          {
+          typedef std::chrono::steady_clock  _Clock;
+
+          std::vector<double>  __latency( __count );
+          __u64                __settled{ 0 };
+          bool                 __reset = reset_peak_rss();
+
+          auto  __start = _Clock::now();
+          for( __u32 __i{ 0 }; __i < __count; __i++ )
+            {
+            auto  __q = _Clock::now();
+            __settled += __f( __i );
+            __latency[__i] = std::chrono::duration<double>( _Clock::now() - __q ).count();
+            }
+          auto  __stop = _Clock::now();
+
+          std::sort( __latency.begin(), __latency.end() );
+
+          pbench_record  __r;
+          __r._S_graph       = __graph;
+          __r._S_phase       = __phase;
+          __r._S_vertices    = __vertices;
+          __r._S_seconds     = std::chrono::duration<double>( __stop - __start ).count();
+          __r._S_peak_rss_kb = peak_rss_kb();
+          __r._S_phase_rss   = __reset;
+          if( __count > 0 )
+            { __r._S_settled = static_cast<double>( __settled ) / __count; }
+          __r._S_p50_seconds = latency_percentile( __latency, 0.50 );
+          __r._S_p90_seconds = latency_percentile( __latency, 0.90 );
+          __r._S_p99_seconds = latency_percentile( __latency, 0.99 );
+
+          _M_checksum += __settled;
+          _M_records.push_back( __r );
+          return __r._S_seconds;
+          }
+//--------------------------------------------------------------------
+// Все фазы на симметричном CSR-графе. Обход начинается с вершины
+// наибольшей степени, чтобы не попасть в изолированную вершину.
+      auto
+      run( const std::string& __name, const pcsr_view& __g ) -> void
+        {
+        __u32  __n = __g.vertex_bound();
+        __u64  __m = __g.edge_count();
+
+        if( __n == 0 )
+          { return; }
+
+        __u32  __root{ 0 };
+        for( __u32 __v{ 1 }; __v < __n; __v++ )
+          {
+          if( __g.degree( __v ) > __g.degree( __root ) )
+            { __root = __v; }
+          }
+
+        measure( __name, "bfs", __n, __m, [&]()
+          { return static_cast<__u64>( bfs_levels( __g, __root )[__n - 1] ); } );
+
+        measure( __name, "dfs", __n, __m, [&]()
+          { return static_cast<__u64>( dfs_preorder( __g, __root ).size() ); } );
+
+        std::vector<__u64>  __reference;
+        double  __sequential = measure( __name, "dijkstra", __n, __m, [&]()
+          {
+          __reference = dijkstra( __g, __root );
+          return __reference[__n - 1];
+          } );
+
+        /** Пул создается до замера: в фазу входит только поиск.
+         */
+        __u64  __delta = mean_weight( __g );
+        for( __u32 __t : _M_sssp_threads )
+          {
+          ptask_pool          __pool( __t );
+          std::vector<__u64>  __dist;
+
+          double  __seconds = measure( __name, "delta_stepping_" + std::to_string( __t ),
+                                       __n, __m, [&]()
+            {
+            __dist = delta_stepping( __g, __root, __delta, __pool );
+            return __dist[__n - 1];
+            } );
+
+          if( __dist != __reference )
+            { throw pexception( "E: delta_stepping() расходится с dijkstra()." ); }
+
+          if( __seconds > 0.0 )
+            { _M_records.back()._S_speedup = __sequential / __seconds; }
+          }
+
+        __u32  __sources = _M_apsp_sources < __n ? _M_apsp_sources : __n;
+        measure( __name, "apsp", __n, __m * __sources, [&]()
+          {
+          std::vector<__u64>  __sum( __sources, 0 );
+
+          /** Источники равномерно по номерам вершин.
+           */
+          parallel_for( 0, __sources, _M_threads, [&]( __u64 __i )
+            {
+            __u32  __s = static_cast<__u32>( __i * __n / __sources );
+            for( __u64 __d : dijkstra( __g, __s ) )
+              {
+              if( __d != unreachable_distance )
+                { __sum[__i] += __d; }
+              }
+            }, 1 );
+
+          __u64  __total{ 0 };
+          for( __u64 __s : __sum )
+            { __total += __s; }
+          return __total;
+          } );
+
+        measure( __name, "components", __n, __m, [&]()
+          { return static_cast<__u64>( connected_components( __g )[__n - 1] ); } );
+
+        measure( __name, "components_parallel", __n, __m, [&]()
+          {
+          return static_cast<__u64>(
+            connected_components_parallel( __g, _M_threads )[__n - 1] );
+          } );
+        }
+//--------------------------------------------------------------------
+// Поиск пути между __queries случайными парами вершин решетки
+// __width x __height (вершина y * __width + x, как в generate_grid()).
+// Вес ребра решетки не меньше 1 - длины ребра, поэтому евклидова
+// эвристика с масштабом 1 допустима. Стоимости путей трех фаз
+// должны совпадать, иначе - исключение.
+      auto
+      run_search( const std::string& __name, const pcsr_view& __g,
+                  __u32 __width, __u32 __height,
+                  __u32 __queries = 256, __u64 __seed = 1 ) -> void
+        {
+        __u32  __n = __width * __height;
+        if( __n == 0 || __n > __g.vertex_bound() )
+          { return; }
+
+        std::vector<double>  __x( __n );
+        std::vector<double>  __y( __n );
+        for( __u32 __v{ 0 }; __v < __n; __v++ )
+          {
+          __x[__v] = static_cast<double>( __v % __width );
+          __y[__v] = static_cast<double>( __v / __width );
+          }
+
+        std::vector<std::pair<__u32, __u32>>  __pairs( __queries );
+        psplitmix64  __rng( __seed );
+        for( std::pair<__u32, __u32>& __q : __pairs )
+          { __q = { __rng.below( __n ), __rng.below( __n ) }; }
+
+        std::vector<__u64>  __cost( __queries );
+        psearch_space       __fwd;
+        psearch_space       __bwd;
+
+        measure_queries( __name, "astar_zero", __n, __queries, [&]( __u32 __i )
+          {
+          ppath_result  __r = astar( __g, __pairs[__i].first, __pairs[__i].second,
+                                     pzero_heuristic(), __fwd );
+          __cost[__i] = __r._S_cost;
+          return __r._S_settled;
+          } );
+
+        /** Остальные фазы сверяются с astar_zero.
+         */
+        auto __check = [&]( __u32 __i, const ppath_result& __r )
+          {
+          if( __r._S_cost != __cost[__i] )
+            { throw pexception( "E: Стоимости путей поиска не совпадают." ); }
+          return __r._S_settled;
+          };
+
+        peuclidean_heuristic  __h( __x.data(), __y.data() );
+        measure_queries( __name, "astar_euclid", __n, __queries, [&]( __u32 __i )
+          {
+          return __check( __i, astar( __g, __pairs[__i].first, __pairs[__i].second,
+                                      __h, __fwd ) );
+          } );
+
+        measure_queries( __name, "bidirectional", __n, __queries, [&]( __u32 __i )
+          {
+          return __check( __i, bidirectional_dijkstra( __g, __g, __pairs[__i].first,
+                                                       __pairs[__i].second,
+                                                       __fwd, __bwd ) );
+          } );
+        }
+//--------------------------------------------------------------------
+      auto
+      records() const -> const std::vector<pbench_record>&
+        { return _M_records; }
+//--------------------------------------------------------------------
+// Вывод записей в CSV с заголовком.
+      auto
+      write_csv( std::ostream& __out ) const -> void
+        {
+        __out << "graph,phase,vertices,edges,seconds,edges_per_second,peak_rss_kb,"
+                 "phase_rss,speedup,settled,p50_seconds,p90_seconds,p99_seconds\n";
+        for( const pbench_record& __r : _M_records )
+          {
+          __out << __r._S_graph << ',' << __r._S_phase << ','
+                << __r._S_vertices << ',' << __r._S_edges << ','
+                << __r._S_seconds << ',' << __r._S_edges_per_second << ','
+                << __r._S_peak_rss_kb << ',' << __r._S_phase_rss << ','
+                << __r._S_speedup << ','
+                << __r._S_settled << ',' << __r._S_p50_seconds << ','
+                << __r._S_p90_seconds << ',' << __r._S_p99_seconds << '\n';
+          }
+        }
+//--------------------------------------------------------------------
+// Вывод записей в JSON - массив объектов с полями как в CSV.
+// Имена графов и фаз не экранируются: они задаются вызывающим кодом
+// и не должны содержать кавычек.
+      auto
+      write_json( std::ostream& __out ) const -> void
+        {
+        __out << "[\n";
+        for( __u64 __i{ 0 }; __i < _M_records.size(); __i++ )
+          {
+          const pbench_record&  __r = _M_records[__i];
+          __out << "  {\"graph\": \"" << __r._S_graph
+                << "\", \"phase\": \"" << __r._S_phase
+                << "\", \"vertices\": " << __r._S_vertices
+                << ", \"edges\": " << __r._S_edges
+                << ", \"seconds\": " << __r._S_seconds
+                << ", \"edges_per_second\": " << __r._S_edges_per_second
+                << ", \"peak_rss_kb\": " << __r._S_peak_rss_kb
+                << ", \"phase_rss\": " << ( __r._S_phase_rss ? "true" : "false" )
+                << ", \"speedup\": " << __r._S_speedup
+                << ", \"settled\": " << __r._S_settled
+                << ", \"p50_seconds\": " << __r._S_p50_seconds
+                << ", \"p90_seconds\": " << __r._S_p90_seconds
+                << ", \"p99_seconds\": " << __r._S_p99_seconds << '}'
+                << ( __i + 1 < _M_records.size() ? ",\n" : "\n" );
+          }
+        __out << "]\n";
+        }
+
+    }; // class pgraph_bench
+//--------------------------------------------------------------------
+// Полный прогон: для каждого масштаба s (2^s вершин) строятся графы
+// R-MAT, Эрдёша-Реньи, решетка и Барабаши-Альберт со средней
+// степенью около 16 и весами 1..255; генерация и построение CSR
+// замеряются как отдельные фазы. На решетке, кроме того, замеряется
+// поиск пути между 256 случайными парами (run_search()). Результат - в
+// CSV или JSON.
+  inline auto
+  run_graph_benchmarks( std::ostream& __out, const std::vector<__u32>& __scales,
+                        bool __json = false, __u64 __seed = 1,
+                        __u32 __threads = hardware_threads() ) -> void
+    {
+    const __u32  __max_weight{ 255 };
+
+    pgraph_bench  __bench( __threads );
+
+    for( __u32 __scale : __scales )
+      {
+      __u32  __n    = 1u << __scale;
+      __u32  __side = 1u << ( __scale / 2 );
+
+      struct _Family
+        {
+        std::string  _S_name;
+        __u32        _S_n;
+        };
+
+      const _Family  __families[] = {
+        { "rmat",            __n },
+        { "erdos_renyi",     __n },
+        { "grid",            __side * ( __n / __side ) },
+        { "barabasi_albert", __n } };
+
+      for( const _Family& __f : __families )
+        {
+        std::string         __name = __f._S_name + "_" + std::to_string( __scale );
+        std::vector<pedge>  __edges;
+        pcsr_graph          __csr;
+
+        __bench.measure( __name, "generate", __f._S_n, 0, [&]()
+          {
+          if( __f._S_name == "rmat" )
+            { __edges = generate_rmat( __scale, 8, __seed, __max_weight ); }
+          else if( __f._S_name == "erdos_renyi" )
+            { __edges = generate_erdos_renyi( __n, 8ULL * __n, __seed, __max_weight ); }
+          else if( __f._S_name == "grid" )
+            { __edges = generate_grid( __side, __n / __side, __seed, __max_weight ); }
+          else
+            { __edges = generate_barabasi_albert( __n, 8, __seed, __max_weight ); }
+          return static_cast<__u64>( __edges.size() );
+          } );
+
+        __bench.measure( __name, "build", __f._S_n, 2 * __edges.size(), [&]()
+          {
+          __csr = pcsr_graph( __f._S_n, __edges, true, true );
+          return __csr.view().edge_count();
+          } );
+
+        __bench.run( __name, __csr.view() );
+
+        if( __f._S_name == "grid" )
+          { __bench.run_search( __name, __csr.view(), __side, __n / __side, 256, __seed ); }
+        }
+      }
+
+    if( __json )
+      { __bench.write_json( __out ); }
+    else
+      { __bench.write_csv( __out ); }
+    }
+
+  } // namespace ptl
+
+#endif // __PTL_PGRAPHBENCH_H__
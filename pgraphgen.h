@@ -0,0 +1,281 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для генераторов синтетических графов.
+ */
+
+/**
+ *  (PTL) Patriarch library : pgraphgen.h
+ */
+
+#pragma once
+#if !defined( __PTL_PGRAPHGEN_H__ )
+#define __PTL_PGRAPHGEN_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#if !defined( __PTL_PEXCEPT_H__ )
+#include "pexcept.h"
+#endif
+
+#if !defined( __PTL_PCSR_H__ )
+#include "pcsr.h"
+#endif
+
+#include <vector>
+
+/*
+ * Детерминированные генераторы графов. Одинаковые параметры и
+ * зерно дают одинаковый список ребер на любой платформе: генератор
+ * псевдослучайных чисел и все преобразования реализованы здесь,
+ * без распределений стандартной библиотеки.
+ *
+ * Результат - список ребер неориентированного графа; веса равномерны
+ * в [1, __max_weight]. Граф строится как
+ * pcsr_graph( n, edges, true, __max_weight > 1 ).
+ *
+ * Классы:
+ *   - psplitmix64 - генератор псевдослучайных чисел SplitMix64
+ *
+ * Функции:
+ *   - generate_rmat() - R-MAT / Кронекер (по умолчанию параметры Graph500)
+ *   - generate_erdos_renyi() - случайный граф G(n, m) Эрдёша-Реньи
+ *   - generate_grid() - двумерная решетка
+ *   - generate_barabasi_albert() - степенной граф Барабаши-Альберт
+ *
+ * @code
+ *   std::vector<ptl::pedge> edges = ptl::generate_rmat( 20, 16, 42 );
+ *   ptl::pcsr_graph graph( 1u << 20, edges, true );
+ * @endcode
+ */
+
+namespace ptl
+  {
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Генератор псевдослучайных чисел SplitMix64.
+   */
+  class psplitmix64
+    {
+    private:
+      __u64  _M_state;
+
+    public:
+      explicit
+      psplitmix64( __u64 __seed )
+        : _M_state( __seed )
+        { }
+//--------------------------------------------------------------------
+// Следующее 64-битное число.
+      auto
+      next() -> __u64
+        {
+        __u64  __z = ( _M_state += 0x9E3779B97F4A7C15ULL );
+        __z = ( __z ^ ( __z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+        __z = ( __z ^ ( __z >> 27 ) ) * 0x94D049BB133111EBULL;
+        return __z ^ ( __z >> 31 );
+        }
+//--------------------------------------------------------------------
+// Равномерное число из [0, __bound) умножением со сдвигом.
+      auto
+      below( __u32 __bound ) -> __u32
+        { return static_cast<__u32>( ( ( next() >> 32 ) * __bound ) >> 32 ); }
+//--------------------------------------------------------------------
+// Равномерное число из [0, __bound) для 64-битной границы. Для
+// границ до 2^32 совпадает с below(), поэтому последовательности
+// прежних генераторов не меняются.
+      auto
+      below64( __u64 __bound ) -> __u64
+        {
+        if( __bound <= 0xFFFFFFFFULL )
+          { return below( static_cast<__u32>( __bound ) ); }
+        return static_cast<__u64>( ( static_cast<unsigned __int128>( next() ) * __bound ) >> 64 );
+        }
+//--------------------------------------------------------------------
+// Равномерное число из [0, 1).
+      auto
+      real() -> double
+        { return static_cast<double>( next() >> 11 ) * ( 1.0 / 9007199254740992.0 ); }
+
+    }; // class psplitmix64
+
+  namespace __detail
+    {
+    inline auto
+    gen_weight( psplitmix64& __rng, __u32 __max_weight ) -> __u32
+      { return __max_weight <= 1 ? 1 : 1 + __rng.below( __max_weight ); }
+    } // namespace __detail
+//--------------------------------------------------------------------
+// R-MAT (рекурсивная матрица) на 2^__scale вершинах и
+// __edge_factor * 2^__scale ребрах. Каждое ребро выбирает квадрант
+// матрицы смежности с вероятностями a, b, c, 1-a-b-c на каждом из
+// __scale уровней. Номера вершин перемешиваются, чтобы степень не
+// коррелировала с номером. Петли отбрасываются, кратные ребра
+// допустимы.
+  inline auto
+  generate_rmat( __u32 __scale, __u32 __edge_factor, __u64 __seed,
+                 __u32 __max_weight = 1,
+                 double __a = 0.57, double __b = 0.19,
+                 double __c = 0.19 ) -> std::vector<pedge>
+    {
+    if( __scale == 0 || __scale > 31 )
+      { throw pexception( "E: Масштаб R-MAT должен быть в пределах 1..31." ); }
+
+    __u32               __n = 1u << __scale;
+    __u64               __m = static_cast<__u64>( __edge_factor ) * __n;
+    psplitmix64         __rng( __seed );
+    std::vector<pedge>  __edges;
+
+    /** Случайная перестановка номеров вершин (Фишер-Йетс).
+     */
+    std::vector<__u32>  __perm( __n );
+    for( __u32 __i{ 0 }; __i < __n; __i++ )
+      { __perm[__i] = __i; }
+    for( __u32 __i = __n - 1; __i > 0; __i-- )
+      {
+      __u32  __j = __rng.below( __i + 1 );
+      __u32  __t = __perm[__i];
+      __perm[__i] = __perm[__j];
+      __perm[__j] = __t;
+      }
+
+    __edges.reserve( __m );
+
+    for( __u64 __e{ 0 }; __e < __m; __e++ )
+      {
+      __u32  __u{ 0 };
+      __u32  __v{ 0 };
+
+      for( __u32 __bit = __n >> 1; __bit != 0; __bit >>= 1 )
+        {
+        double  __r = __rng.real();
+
+        if( __r < __a )
+          { }
+        else if( __r < __a + __b )
+          { __v |= __bit; }
+        else if( __r < __a + __b + __c )
+          { __u |= __bit; }
+        else
+          {
+          __u |= __bit;
+          __v |= __bit;
+          }
+        }
+
+      if( __u == __v )
+        { continue; }
+
+      __edges.push_back( { __perm[__u], __perm[__v],
+                           __detail::gen_weight( __rng, __max_weight ) } );
+      }
+
+    return __edges;
+    }
+//--------------------------------------------------------------------
+// Случайный граф G(n, m) Эрдёша-Реньи: __m ребер с концами,
+// выбранными равномерно. Петли отбрасываются.
+  inline auto
+  generate_erdos_renyi( __u32 __n, __u64 __m, __u64 __seed,
+                        __u32 __max_weight = 1 ) -> std::vector<pedge>
+    {
+    psplitmix64         __rng( __seed );
+    std::vector<pedge>  __edges;
+
+    if( __n < 2 )
+      { return __edges; }
+
+    __edges.reserve( __m );
+
+    while( __edges.size() < __m )
+      {
+      __u32  __u = __rng.below( __n );
+      __u32  __v = __rng.below( __n );
+
+      if( __u != __v )
+        { __edges.push_back( { __u, __v, __detail::gen_weight( __rng, __max_weight ) } ); }
+      }
+
+    return __edges;
+    }
+//--------------------------------------------------------------------
+// Двумерная решетка __width x __height: вершина y * __width + x
+// соединена с правым и нижним соседями.
+  inline auto
+  generate_grid( __u32 __width, __u32 __height, __u64 __seed,
+                 __u32 __max_weight = 1 ) -> std::vector<pedge>
+    {
+    psplitmix64         __rng( __seed );
+    std::vector<pedge>  __edges;
+
+    __edges.reserve( 2ULL * __width * __height );
+
+    for( __u32 __y{ 0 }; __y < __height; __y++ )
+      {
+      for( __u32 __x{ 0 }; __x < __width; __x++ )
+        {
+        __u32  __v = __y * __width + __x;
+
+        if( __x + 1 < __width )
+          { __edges.push_back( { __v, __v + 1, __detail::gen_weight( __rng, __max_weight ) } ); }
+        if( __y + 1 < __height )
+          { __edges.push_back( { __v, __v + __width,
+                                 __detail::gen_weight( __rng, __max_weight ) } ); }
+        }
+      }
+
+    return __edges;
+    }
+//--------------------------------------------------------------------
+// Степенной граф Барабаши-Альберт: каждая новая вершина соединяется
+// с __k вершинами, выбранными с вероятностью, пропорциональной
+// степени. Выбор пропорционально степени - равномерный выбор из
+// списка концов всех ребер.
+  inline auto
+  generate_barabasi_albert( __u32 __n, __u32 __k, __u64 __seed,
+                            __u32 __max_weight = 1 ) -> std::vector<pedge>
+    {
+    if( __k == 0 )
+      { throw pexception( "E: Степень присоединения должна быть больше 0." ); }
+
+    psplitmix64         __rng( __seed );
+    std::vector<pedge>  __edges;
+    std::vector<__u32>  __ends; // концы всех ребер
+
+    if( __n <= __k )
+      { return __edges; }
+
+    __edges.reserve( static_cast<__u64>( __n ) * __k );
+    __ends.reserve( 2ULL * __n * __k );
+
+    /** Затравка - звезда из вершины __k в вершины 0..__k-1.
+     */
+    for( __u32 __v{ 0 }; __v < __k; __v++ )
+      {
+      __edges.push_back( { __k, __v, __detail::gen_weight( __rng, __max_weight ) } );
+      __ends.push_back( __k );
+      __ends.push_back( __v );
+      }
+
+    for( __u32 __v = __k + 1; __v < __n; __v++ )
+      {
+      for( __u32 __j{ 0 }; __j < __k; __j++ )
+        {
+        __u32  __u = __ends[__rng.below64( __ends.size() )];
+
+        __edges.push_back( { __v, __u, __detail::gen_weight( __rng, __max_weight ) } );
+        __ends.push_back( __v );
+        __ends.push_back( __u );
+        }
+      }
+
+    return __edges;
+    }
+
+  } // namespace ptl
+
+#endif // __PTL_PGRAPHGEN_H__
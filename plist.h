@@ -29,7 +29,7 @@
  * Связанный список данных. 
  *
  * Методы:
- *   - push() - вставка в конец списка
+ *   - push() - вставка в конец списка за O(1)
  *   - push_front() - вставка в начало списка
  *   - insert() - вставка в середину списка
  *   - remove() - удаление узла списка по значению
@@ -37,6 +37,10 @@
  *   - show() - вывод содержимого списка через пробел
  *   - clear() - удаление всего списка
  *   - find() - поиск элемента в списке (найден - true, нет - false)
+ *   - size() - количество элементов списка
+ *
+ * Узлы берутся из пула списка (pnode_pool), который выделяет память
+ * пластами и повторно использует освобожденные узлы.
  *
  * @code
  *   ptl::plist<ptl::__s32> list;
@@ -55,13 +59,21 @@ namespace ptl
   class plist
     {
     private:
-      pnode<_Tp>*  _M_head; // Начало связанного списка данных.
+      pnode<_Tp>*      _M_head; // Начало связанного списка данных.
+      pnode<_Tp>*      _M_tail; // Последний узел списка.
+      __u32            _M_size; // Количество узлов.
+      pnode_pool<_Tp>  _M_pool; // Память узлов.
 
     public:
       plist() 
-        : _M_head( nullptr )
+        : _M_head( nullptr ), _M_tail( nullptr ), _M_size( 0 )
         { }
 
+      plist( const plist& ) = delete;
+
+      plist&
+      operator=( const plist& ) = delete;
+
       ~plist() noexcept
         { clear(); }
 //--------------------------------------------------------------------
@@ -70,37 +82,34 @@ namespace ptl
         {
         /** Создаем новый узел.
          */
-        pnode<_Tp>* node = new pnode<_Tp>( __data );
+        pnode<_Tp>* node = _M_pool.create( __data );
+        _M_size++;
 
-        /** Если список пуст, то возвращаем узел.
+        /** Если список пуст, то узел становится началом и концом.
          */
         if( _M_head == nullptr )
           {
-          _M_head = node;
+          _M_head = _M_tail = node;
           return;
           }
 
-        /** Ищем последний элемент списка.
-         */
-        pnode<_Tp>* last = _M_head;
-        while( last->_M_next != nullptr )
-          {
-          last = last->_M_next;
-          }
-
         /** Обновляем указатель _M_next последнего узла на 
          *  указатель на новый узел.
          */
-        last->_M_next = node;
-        return;
+        _M_tail->_M_next = node;
+        _M_tail = node;
         }
 //--------------------------------------------------------------------
       auto
       push_front( _Tp __data ) -> void
         {
-        pnode<_Tp>* node = new pnode<_Tp>( __data );
+        pnode<_Tp>* node = _M_pool.create( __data );
         node->_M_next = _M_head;
         _M_head = node;
+        _M_size++;
+
+        if( _M_tail == nullptr )
+          { _M_tail = node; }
         }
 //--------------------------------------------------------------------
       auto
@@ -108,13 +117,14 @@ namespace ptl
         {
         /** Создаем новый узел.
          */
-        pnode<_Tp>* new_node = new pnode<_Tp>( __data );
+        pnode<_Tp>* new_node = _M_pool.create( __data );
+        _M_size++;
 
         /** Если список пуст, то новый узел и будет началом списка.
          */
         if( _M_head == nullptr )
           {
-          _M_head = new_node;
+          _M_head = _M_tail = new_node;
           return;
           }
 
@@ -151,6 +161,9 @@ namespace ptl
          *  следующий за current.
          */
         new_node->_M_next = next;
+
+        if( next == nullptr )
+          { _M_tail = new_node; }
         }
 //--------------------------------------------------------------------
       auto
@@ -163,8 +176,7 @@ namespace ptl
          */
         if( temp && temp->_M_data == __data )
           {
-          _M_head = temp->_M_next;
-          delete temp;
+          unlink( nullptr, temp );
           return;
           }
 
@@ -186,8 +198,7 @@ namespace ptl
          *  узел, следующий за удаляемым узлом, и удаляем узел с
          *  данными.
          */
-        prev->_M_next = temp->_M_next;
-        delete temp;
+        unlink( prev, temp );
         }
 //--------------------------------------------------------------------
       auto
@@ -198,10 +209,12 @@ namespace ptl
 
         /** Крайний случай - удаляем начало списка.
          */
+        if( temp == nullptr )
+          return;
+
         if( __position == 0 )
           {
-          _M_head = temp->_M_next;
-          delete temp;
+          unlink( nullptr, temp );
           return;
           }
 
@@ -223,8 +236,7 @@ namespace ptl
          *  узел, следующий за удаляемым узлом, и удаляем узел с
          *  данными.
          */
-        prev->_M_next = temp->_M_next;
-        delete temp;
+        unlink( prev, temp );
         }
 //--------------------------------------------------------------------
       auto
@@ -248,11 +260,13 @@ namespace ptl
         while( currend != nullptr )
           {
           pnode<_Tp>* temp = currend->_M_next;
-          delete currend;
+          _M_pool.destroy( currend );
           currend = temp;
           }
 
         _M_head = nullptr;
+        _M_tail = nullptr;
+        _M_size = 0;
         }
 //--------------------------------------------------------------------
       auto
@@ -269,6 +283,29 @@ namespace ptl
 
         return false;
         }
+//--------------------------------------------------------------------
+      auto
+      size() const -> __u32
+        { return _M_size; }
+
+    private:
+//--------------------------------------------------------------------
+      // Исключение узла __node, следующего за __prev (nullptr - начало
+      // списка), и возврат его в пул.
+      auto
+      unlink( pnode<_Tp>* __prev, pnode<_Tp>* __node ) -> void
+        {
+        if( __prev == nullptr )
+          { _M_head = __node->_M_next; }
+        else
+          { __prev->_M_next = __node->_M_next; }
+
+        if( _M_tail == __node )
+          { _M_tail = __prev; }
+
+        _M_pool.destroy( __node );
+        _M_size--;
+        }
     };
 
   } // namespace ptl
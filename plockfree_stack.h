@@ -0,0 +1,272 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для стека без блокировок.
+ */
+
+/**
+ *  (PTL) Patriarch library : plockfree_stack.h
+ */
+
+#pragma once
+#if !defined( __PTL_PLOCKFREE_STACK_H__ )
+#define __PTL_PLOCKFREE_STACK_H__
+
+#if !defined( __PTL_PNODE_H__ )
+#include "pnode.h"
+#endif
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#if !defined( __PTL_PEXCEPT_H__ )
+#include "pexcept.h"
+#endif
+
+#if !defined( __PTL_PPARALLEL_H__ )
+#include "pparallel.h"
+#endif
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+/*
+ * Стек без блокировок (Treiber) на узлах pnode.
+ *
+ * Проблема ABA: поток прочитал вершину A и ее следующий узел, а до
+ * его CAS другие потоки сняли A, сняли еще узлы и вернули A обратно;
+ * CAS по одному указателю прошел бы и записал устаревший следующий
+ * узел. Поэтому вершина хранится вместе с 16-битным счетчиком
+ * изменений в одном 64-битном слове (указатель занимает младшие 48
+ * бит), и CAS проходит, только если не было ни одного изменения.
+ *
+ * Безопасность памяти: поток может прочитать _M_next узла, который
+ * уже снят и передан другому потоку. Снятые узлы не освобождаются, а
+ * уходят во внутренний список свободных узлов (такой же стек) и
+ * используются повторно, поэтому память узла всегда действительна;
+ * устаревшее значение _M_next отвергается счетчиком. _M_next
+ * читается и пишется атомарно. Память узлов возвращается в
+ * деструкторе.
+ *
+ * Методы:
+ *   - push() - добавление элемента на вершину стека
+ *   - try_pop() - снятие элемента с вершины; false - стек пуст
+ *   - pop_all() - снятие всех элементов одной атомарной операцией
+ *   - is_empty() - проверка стека на пустоту
+ *
+ * @code
+ *   ptl::plockfree_stack<work_item*> free_items;
+ *   free_items.push( item );
+ *   work_item* next;
+ *   if( free_items.try_pop( next ) ) { ... }
+ *   free_items.pop_all( []( work_item* w ) { delete w; } );
+ * @endcode
+ */
+
+namespace ptl
+  {
+//////////////////////////////////////////////////////////////////////
+  template <typename _Tp>
+  class plockfree_stack
+    {
+    private:
+      static constexpr __u32  __pointer_bits = 48;
+      static constexpr __u64  __pointer_mask = ( 1ULL << __pointer_bits ) - 1;
+
+      alignas( cache_line_size ) std::atomic<__u64>  _M_top{ 0 };  // Вершина стека
+      alignas( cache_line_size ) std::atomic<__u64>  _M_free{ 0 }; // Свободные узлы
+
+      static auto
+      node( __u64 __word ) -> pnode<_Tp>*
+        { return reinterpret_cast<pnode<_Tp>*>( __word & __pointer_mask ); }
+
+      // Слово с узлом __n и счетчиком, увеличенным относительно __old.
+      static auto
+      next_word( __u64 __old, pnode<_Tp>* __n ) -> __u64
+        {
+        return ( ( ( __old >> __pointer_bits ) + 1 ) << __pointer_bits )
+               | reinterpret_cast<std::uintptr_t>( __n );
+        }
+
+      static auto
+      load_next( pnode<_Tp>* __n ) -> pnode<_Tp>*
+        { return __atomic_load_n( &__n->_M_next, __ATOMIC_RELAXED ); }
+
+      static auto
+      store_next( pnode<_Tp>* __n, pnode<_Tp>* __next ) -> void
+        { __atomic_store_n( &__n->_M_next, __next, __ATOMIC_RELAXED ); }
+//--------------------------------------------------------------------
+      // Присоединение цепочки __first..__last к вершине __head.
+      static auto
+      push_chain( std::atomic<__u64>& __head, pnode<_Tp>* __first,
+                  pnode<_Tp>* __last ) -> void
+        {
+        __u64  __old = __head.load( std::memory_order_relaxed );
+
+        for( ;; )
+          {
+          store_next( __last, node( __old ) );
+          if( __head.compare_exchange_weak( __old, next_word( __old, __first ),
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed ) )
+            { return; }
+          }
+        }
+//--------------------------------------------------------------------
+      // Снятие узла с вершины __head; nullptr - стек пуст.
+      static auto
+      pop_node( std::atomic<__u64>& __head ) -> pnode<_Tp>*
+        {
+        __u64  __old = __head.load( std::memory_order_acquire );
+
+        for( ;; )
+          {
+          pnode<_Tp>*  __n = node( __old );
+          if( __n == nullptr )
+            { return nullptr; }
+
+          if( __head.compare_exchange_weak( __old, next_word( __old, load_next( __n ) ),
+                                            std::memory_order_acquire,
+                                            std::memory_order_acquire ) )
+            { return __n; }
+          }
+        }
+//--------------------------------------------------------------------
+      // Узел со значением __data: из списка свободных или новый.
+      template <typename _Up>
+        auto
+        make_node( _Up&& __data ) -> pnode<_Tp>*
+          {
+          pnode<_Tp>*  __n = pop_node( _M_free );
+
+          if( __n != nullptr )
+            {
+            __n->_M_data = std::forward<_Up>( __data );
+            return __n;
+            }
+
+          __n = new pnode<_Tp>( std::forward<_Up>( __data ) );
+          if( ( reinterpret_cast<std::uintptr_t>( __n ) & ~__pointer_mask ) != 0 )
+            {
+            delete __n;
+            throw pexception( "E: Адрес узла не помещается в 48 бит." );
+            }
+          return __n;
+          }
+//--------------------------------------------------------------------
+      // Освобождение цепочки, начинающейся с __n (однопоточно).
+      static auto
+      delete_chain( pnode<_Tp>* __n ) -> void
+        {
+        while( __n != nullptr )
+          {
+          pnode<_Tp>*  __next = __n->_M_next;
+          delete __n;
+          __n = __next;
+          }
+        }
+
+    public:
+      plockfree_stack() = default;
+
+      plockfree_stack( const plockfree_stack& ) = delete;
+
+      plockfree_stack&
+      operator=( const plockfree_stack& ) = delete;
+
+      ~plockfree_stack() noexcept
+        {
+        delete_chain( node( _M_top.load( std::memory_order_acquire ) ) );
+        delete_chain( node( _M_free.load( std::memory_order_acquire ) ) );
+        }
+//--------------------------------------------------------------------
+      auto
+      push( const _Tp& __data ) -> void
+        {
+        pnode<_Tp>*  __n = make_node( __data );
+        push_chain( _M_top, __n, __n );
+        }
+//--------------------------------------------------------------------
+      auto
+      push( _Tp&& __data ) -> void
+        {
+        pnode<_Tp>*  __n = make_node( std::move( __data ) );
+        push_chain( _M_top, __n, __n );
+        }
+//--------------------------------------------------------------------
+// Снятие элемента с вершины в __out.
+      auto
+      try_pop( _Tp& __out ) -> bool
+        {
+        pnode<_Tp>*  __n = pop_node( _M_top );
+        if( __n == nullptr )
+          { return false; }
+
+        __out = std::move( __n->_M_data );
+        push_chain( _M_free, __n, __n );
+        return true;
+        }
+//--------------------------------------------------------------------
+// Снятие всех элементов одной атомарной операцией и вызов
+// __f( element ) для каждого от вершины к основанию.
+// Возвращает количество снятых элементов. Если __f выбросит
+// исключение, еще не переданные элементы возвращаются в стек, а узлы
+// переданных - в список свободных; исключение пробрасывается дальше.
+      template <typename _Func>
+        auto
+        pop_all( _Func __f ) -> __u64
+          {
+          __u64  __old = _M_top.load( std::memory_order_relaxed );
+
+          while( node( __old ) != nullptr
+                 && !_M_top.compare_exchange_weak( __old, next_word( __old, nullptr ),
+                                                   std::memory_order_acquire,
+                                                   std::memory_order_relaxed ) )
+            { }
+
+          pnode<_Tp>*  __first = node( __old );
+          pnode<_Tp>*  __last{ nullptr };
+          __u64        __count{ 0 };
+
+          /** Цепочка принадлежит только этому потоку.
+           */
+          for( pnode<_Tp>* __n = __first; __n != nullptr; __n = load_next( __n ) )
+            {
+            try
+              { __f( std::move( __n->_M_data ) ); }
+            catch( ... )
+              {
+              pnode<_Tp>*  __rest = load_next( __n );
+              if( __rest != nullptr )
+                {
+                pnode<_Tp>*  __tail = __rest;
+                while( load_next( __tail ) != nullptr )
+                  { __tail = load_next( __tail ); }
+                push_chain( _M_top, __rest, __tail );
+                }
+              push_chain( _M_free, __first, __n );
+              throw;
+              }
+            __last = __n;
+            __count++;
+            }
+
+          if( __first != nullptr )
+            { push_chain( _M_free, __first, __last ); }
+
+          return __count;
+          }
+//--------------------------------------------------------------------
+      auto
+      is_empty() const -> bool
+        { return node( _M_top.load( std::memory_order_acquire ) ) == nullptr; }
+
+    }; // class plockfree_stack
+
+  } // namespace ptl
+
+#endif // __PTL_PLOCKFREE_STACK_H__
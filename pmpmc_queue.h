@@ -0,0 +1,261 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для ограниченной очереди без блокировок
+ * с несколькими производителями и потребителями.
+ */
+
+/**
+ *  (PTL) Patriarch library : pmpmc_queue.h
+ */
+
+#pragma once
+#if !defined( __PTL_PMPMC_QUEUE_H__ )
+#define __PTL_PMPMC_QUEUE_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#if !defined( __PTL_PEXCEPT_H__ )
+#include "pexcept.h"
+#endif
+
+#if !defined( __PTL_PPARALLEL_H__ )
+#include "pparallel.h"
+#endif
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*
+ * Ограниченная очередь без блокировок для нескольких производителей
+ * и потребителей (Д. Вьюков). Кольцо из степени двойки ячеек; у
+ * каждой ячейки порядковый номер, по которому поток видит, свободна
+ * ли ячейка для записи на данном круге или уже заполнена. Позицию
+ * записи или чтения поток захватывает одним CAS, после чего работает
+ * с ячейкой без синхронизации с другими потоками. Позиции записи и
+ * чтения лежат в разных строках кэша.
+ *
+ * Захваченную ячейку нельзя вернуть: если бы перенос элемента в нее
+ * выбросил исключение, ее номер не обновился бы, и очередь навсегда
+ * встала бы на этой позиции. Поэтому перемещение и удаление _Tp не
+ * должны выбрасывать исключений (проверяется при компиляции).
+ * try_push( const _Tp& ) копирует элемент до захвата ячейки;
+ * try_push_n() копирует прямо в ячейки и требует копирования без
+ * исключений.
+ *
+ * Методы:
+ *   - try_push() - вставка элемента; false - очередь заполнена
+ *   - try_pop() - извлечение элемента; false - очередь пуста
+ *   - try_push_n() - вставка до n элементов одним захватом
+ *   - try_pop_n() - извлечение до n элементов одним захватом
+ *   - capacity() - емкость очереди
+ *   - size_approx() - приблизительное количество элементов
+ *
+ * @code
+ *   ptl::pmpmc_queue<ptl::__u32> queue( 1024 );
+ *   queue.try_push( 7 );
+ *   ptl::__u32 x;
+ *   if( queue.try_pop( x ) ) { ... }
+ * @endcode
+ */
+
+namespace ptl
+  {
+//////////////////////////////////////////////////////////////////////
+  template <typename _Tp>
+  class pmpmc_queue
+    {
+      static_assert( std::is_nothrow_move_constructible_v<_Tp>
+                     && std::is_nothrow_move_assignable_v<_Tp>
+                     && std::is_nothrow_destructible_v<_Tp>,
+                     "Перемещение и удаление элемента не должны выбрасывать исключений." );
+
+    private:
+      struct _Cell
+        {
+        std::atomic<__u64>            _S_seq;
+        alignas( _Tp ) unsigned char  _S_storage[sizeof( _Tp )];
+
+        auto
+        data() -> _Tp*
+          { return reinterpret_cast<_Tp*>( _S_storage ); }
+        };
+
+      std::unique_ptr<_Cell[]>  _M_cells;
+      __u64                     _M_mask;
+
+      alignas( cache_line_size ) std::atomic<__u64>  _M_tail{ 0 }; // Позиция записи
+      alignas( cache_line_size ) std::atomic<__u64>  _M_head{ 0 }; // Позиция чтения
+
+//--------------------------------------------------------------------
+      // Захват до __n позиций подряд начиная с __pos из счетчика
+      // __counter. Ячейка позиции p готова, если ее номер равен
+      // p + __lag (0 - для записи, 1 - для чтения). Возвращает
+      // количество захваченных позиций, __pos - первая из них.
+      auto
+      claim( std::atomic<__u64>& __counter, __u64 __lag, __u64 __n,
+             __u64& __pos ) -> __u64
+        {
+        __pos = __counter.load( std::memory_order_relaxed );
+
+        for( ;; )
+          {
+          __u64  __ready{ 0 };
+
+          while( __ready < __n )
+            {
+            __u64  __seq = _M_cells[( __pos + __ready ) & _M_mask]
+                             ._S_seq.load( std::memory_order_acquire );
+            if( __seq != __pos + __ready + __lag )
+              { break; }
+            __ready++;
+            }
+
+          if( __ready == 0 )
+            {
+            /** Первая ячейка не готова: либо очередь заполнена (пуста),
+             *  либо __pos устарела и ее надо перечитать.
+             */
+            __u64  __seq = _M_cells[__pos & _M_mask]._S_seq.load( std::memory_order_acquire );
+            if( static_cast<__s64>( __seq - ( __pos + __lag ) ) < 0 )
+              { return 0; }
+
+            __pos = __counter.load( std::memory_order_relaxed );
+            continue;
+            }
+
+          if( __counter.compare_exchange_weak( __pos, __pos + __ready,
+                                               std::memory_order_relaxed ) )
+            { return __ready; }
+          }
+        }
+
+    public:
+      /** Емкость округляется вверх до степени двойки (не меньше 2).
+       */
+      explicit
+      pmpmc_queue( __u64 __capacity )
+        {
+        if( __capacity == 0 || __capacity > ( 1ULL << 62 ) )
+          { throw pexception( "E: Недопустимая емкость очереди." ); }
+
+        __u64  __size{ 2 };
+        while( __size < __capacity )
+          { __size <<= 1; }
+
+        _M_cells.reset( new _Cell[__size] );
+        _M_mask = __size - 1;
+
+        for( __u64 __i{ 0 }; __i < __size; __i++ )
+          { _M_cells[__i]._S_seq.store( __i, std::memory_order_relaxed ); }
+        }
+
+      pmpmc_queue( const pmpmc_queue& ) = delete;
+
+      pmpmc_queue&
+      operator=( const pmpmc_queue& ) = delete;
+
+      ~pmpmc_queue() noexcept
+        {
+        __u64  __tail = _M_tail.load( std::memory_order_acquire );
+
+        for( __u64 __pos = _M_head.load( std::memory_order_acquire );
+             __pos != __tail; __pos++ )
+          { _M_cells[__pos & _M_mask].data()->~_Tp(); }
+        }
+//--------------------------------------------------------------------
+      auto
+      try_push( const _Tp& __data ) -> bool
+        {
+        if constexpr( std::is_nothrow_copy_constructible_v<_Tp> )
+          { return try_push_n( &__data, 1 ) == 1; }
+        else
+          {
+          _Tp  __copy( __data ); // копия - до захвата ячейки
+          return try_push( std::move( __copy ) );
+          }
+        }
+//--------------------------------------------------------------------
+      auto
+      try_push( _Tp&& __data ) -> bool
+        {
+        __u64  __pos;
+        if( claim( _M_tail, 0, 1, __pos ) == 0 )
+          { return false; }
+
+        _Cell&  __c = _M_cells[__pos & _M_mask];
+        new( __c.data() ) _Tp( std::move( __data ) );
+        __c._S_seq.store( __pos + 1, std::memory_order_release );
+        return true;
+        }
+//--------------------------------------------------------------------
+      auto
+      try_pop( _Tp& __out ) -> bool
+        { return try_pop_n( &__out, 1 ) == 1; }
+//--------------------------------------------------------------------
+// Вставка до __n элементов массива __data подряд.
+// Возвращает количество вставленных (первые из массива).
+      auto
+      try_push_n( const _Tp* __data, __u64 __n ) -> __u64
+        {
+        static_assert( std::is_nothrow_copy_constructible_v<_Tp>,
+                       "try_push_n() требует копирования элемента без исключений." );
+
+        __u64  __pos;
+        __u64  __got = claim( _M_tail, 0, __n, __pos );
+
+        for( __u64 __i{ 0 }; __i < __got; __i++ )
+          {
+          _Cell&  __c = _M_cells[( __pos + __i ) & _M_mask];
+          new( __c.data() ) _Tp( __data[__i] );
+          __c._S_seq.store( __pos + __i + 1, std::memory_order_release );
+          }
+
+        return __got;
+        }
+//--------------------------------------------------------------------
+// Извлечение до __n элементов в массив __out.
+// Возвращает количество извлеченных.
+      auto
+      try_pop_n( _Tp* __out, __u64 __n ) -> __u64
+        {
+        __u64  __pos;
+        __u64  __got = claim( _M_head, 1, __n, __pos );
+
+        for( __u64 __i{ 0 }; __i < __got; __i++ )
+          {
+          _Cell&  __c = _M_cells[( __pos + __i ) & _M_mask];
+          __out[__i] = std::move( *__c.data() );
+          __c.data()->~_Tp();
+          __c._S_seq.store( __pos + __i + _M_mask + 1, std::memory_order_release );
+          }
+
+        return __got;
+        }
+//--------------------------------------------------------------------
+      auto
+      capacity() const -> __u64
+        { return _M_mask + 1; }
+//--------------------------------------------------------------------
+// Приблизительное количество элементов: при одновременных
+// изменениях значение может устареть сразу после чтения.
+      auto
+      size_approx() const -> __u64
+        {
+        __u64  __head = _M_head.load( std::memory_order_relaxed );
+        __u64  __tail = _M_tail.load( std::memory_order_relaxed );
+        return __tail > __head ? __tail - __head : 0;
+        }
+
+    }; // class pmpmc_queue
+
+  } // namespace ptl
+
+#endif // __PTL_PMPMC_QUEUE_H__
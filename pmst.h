@@ -0,0 +1,344 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для минимального остовного дерева графа.
+ */
+
+/**
+ *  (PTL) Patriarch library : pmst.h
+ */
+
+#pragma once
+#if !defined( __PTL_PMST_H__ )
+#define __PTL_PMST_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#if !defined( __PTL_PCSR_H__ )
+#include "pcsr.h"
+#endif
+
+#if !defined( __PTL_PDISJOINT_SET_H__ )
+#include "pdisjoint_set.h"
+#endif
+
+#if !defined( __PTL_PPARALLEL_H__ )
+#include "pparallel.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <tuple>
+#include <vector>
+
+/*
+ * Минимальный остовный лес неориентированного взвешенного графа.
+ * Результат - массив ребер леса; для связного графа это n-1 ребро.
+ *
+ * Функции:
+ *   - kruskal_edges() - алгоритм Краскала по списку ребер
+ *   - kruskal() - алгоритм Краскала по графу с курсорами смежности
+ *   - prim() - алгоритм Прима на двоичной куче
+ *   - boruvka_parallel() - параллельный алгоритм Борувки для CSR-графа
+ *
+ * Классы (способ сортировки ребер для алгоритма Краскала):
+ *   - pstd_sort_backend - сравнением, std::sort
+ *   - pradix_sort_backend - поразрядная сортировка по весу за O(m)
+ *
+ * @code
+ *   std::vector<ptl::pedge> tree = ptl::kruskal( graph );
+ *   std::vector<ptl::pedge> big  = ptl::boruvka_parallel( csr.view(), 8 );
+ * @endcode
+ */
+
+namespace ptl
+  {
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Сортировка ребер по весу сравнением.
+   */
+  struct pstd_sort_backend
+    {
+    auto
+    operator()( std::vector<pedge>& __edges ) const -> void
+      {
+      std::sort( __edges.begin(), __edges.end(),
+                 []( const pedge& __a, const pedge& __b )
+                   { return __a._S_weight < __b._S_weight; } );
+      }
+    };
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Поразрядная (LSD) сортировка ребер по весу, по 8 бит за проход.
+   * Проходы, в которых все ребра имеют одинаковый байт веса,
+   * пропускаются.
+   */
+  struct pradix_sort_backend
+    {
+    auto
+    operator()( std::vector<pedge>& __edges ) const -> void
+      {
+      std::vector<pedge>  __buffer( __edges.size() );
+
+      for( __u32 __shift{ 0 }; __shift < 32; __shift += 8 )
+        {
+        __u64  __count[257] = { };
+
+        for( const pedge& __e : __edges )
+          { __count[( ( __e._S_weight >> __shift ) & 0xFF ) + 1]++; }
+
+        bool  __trivial{ false };
+        for( __u32 __b{ 1 }; __b <= 256; __b++ )
+          {
+          if( __count[__b] == __edges.size() )
+            { __trivial = true; }
+          }
+        if( __trivial )
+          { continue; }
+
+        for( __u32 __b{ 0 }; __b < 256; __b++ )
+          { __count[__b + 1] += __count[__b]; }
+
+        for( const pedge& __e : __edges )
+          { __buffer[__count[( __e._S_weight >> __shift ) & 0xFF]++] = __e; }
+
+        __edges.swap( __buffer );
+        }
+      }
+    };
+//--------------------------------------------------------------------
+// Алгоритм Краскала по списку ребер графа из __n вершин.
+// Ребра просматриваются по возрастанию веса; ребро берется в лес,
+// если соединяет разные компоненты.
+  template <typename _Sort = pstd_sort_backend>
+    auto
+    kruskal_edges( __u32 __n, std::vector<pedge> __edges,
+                   _Sort __sort = _Sort() ) -> std::vector<pedge>
+      {
+      std::vector<pedge>  __tree;
+      pdisjoint_set       __ds( __n );
+
+      __sort( __edges );
+
+      for( const pedge& __e : __edges )
+        {
+        if( __ds.unite( __e._S_from, __e._S_to ) )
+          {
+          __tree.push_back( __e );
+          if( __tree.size() + 1 == __n )
+            { break; }
+          }
+        }
+
+      return __tree;
+      }
+//--------------------------------------------------------------------
+// Алгоритм Краскала по неориентированному графу с курсорами
+// смежности. Каждое ребро берется один раз - со стороны меньшей
+// вершины.
+  template <typename _Graph, typename _Sort = pstd_sort_backend>
+    auto
+    kruskal( const _Graph& __g, _Sort __sort = _Sort() ) -> std::vector<pedge>
+      {
+      __u32               __n{ __g.vertex_bound() };
+      std::vector<pedge>  __edges;
+
+      for( __u32 __v{ 0 }; __v < __n; __v++ )
+        {
+        for( auto __c = __g.adj_begin( __v );
+             __c != __g.adj_end( __v );
+             __c = __g.adj_next( __v, __c ) )
+          {
+          __u32  __w = __g.adj_target( __v, __c );
+          if( __v < __w )
+            { __edges.push_back( { __v, __w, __g.adj_weight( __v, __c ) } ); }
+          }
+        }
+
+      return kruskal_edges( __n, std::move( __edges ), __sort );
+      }
+//--------------------------------------------------------------------
+// Алгоритм Прима на двоичной куче с ленивым удалением.
+// Дерево растет из каждой еще не охваченной вершины, поэтому для
+// несвязного графа строится остовный лес.
+  template <typename _Graph>
+    auto
+    prim( const _Graph& __g ) -> std::vector<pedge>
+      {
+      typedef std::tuple<__u32, __u32, __u32>  _Entry; // вес, куда, откуда
+
+      __u32               __n{ __g.vertex_bound() };
+      std::vector<__u8>   __in_tree( __n, 0 );
+      std::vector<pedge>  __tree;
+      std::priority_queue<_Entry, std::vector<_Entry>,
+                          std::greater<_Entry>>  __heap;
+
+      /** Добавление вершины в дерево и ее ребер в кучу.
+       */
+      auto __take = [&]( __u32 __v )
+        {
+        __in_tree[__v] = 1;
+
+        for( auto __c = __g.adj_begin( __v );
+             __c != __g.adj_end( __v );
+             __c = __g.adj_next( __v, __c ) )
+          {
+          __u32  __w = __g.adj_target( __v, __c );
+          if( !__in_tree[__w] )
+            { __heap.push( _Entry( __g.adj_weight( __v, __c ), __w, __v ) ); }
+          }
+        };
+
+      for( __u32 __root{ 0 }; __root < __n; __root++ )
+        {
+        if( __in_tree[__root] )
+          { continue; }
+
+        __take( __root );
+
+        while( !__heap.empty() )
+          {
+          _Entry  __e = __heap.top();
+          __heap.pop();
+
+          __u32  __w = std::get<1>( __e );
+          if( __in_tree[__w] )
+            { continue; }
+
+          __tree.push_back( { std::get<2>( __e ), __w, std::get<0>( __e ) } );
+          __take( __w );
+          }
+        }
+
+      return __tree;
+      }
+//--------------------------------------------------------------------
+// Параллельный алгоритм Борувки для симметричного CSR-графа.
+// В каждом раунде:
+// 1. Параллельно для каждой вершины ищется самое легкое ребро в
+//    чужую компоненту.
+// 2. Параллельно для каждой компоненты выбирается лучшая из ее
+//    вершин (CAS по номеру вершины).
+// 3. Выбранные ребра объединяют компоненты.
+// Ребра упорядочены по (вес, меньший конец, больший конец), поэтому
+// при равных весах выбор согласован и циклов не возникает. Раундов
+// не больше log2( n ).
+  inline auto
+  boruvka_parallel( const pcsr_view& __g, ptask_pool& __pool )
+    -> std::vector<pedge>
+    {
+    const __u64  __none{ ~0ULL };
+
+    __u32         __n{ __g.vertex_bound() };
+    const __u64*  __off = __g.offsets();
+    const __u32*  __nbr = __g.neighbors();
+
+    std::vector<pedge>   __tree;
+    std::vector<__u32>   __comp( __n );
+    std::vector<__u64>   __best_edge( __n );  // лучшее ребро вершины
+    pdisjoint_set        __ds( __n );
+    std::unique_ptr<std::atomic<__u32>[]>
+                         __best_vertex( new std::atomic<__u32>[__n] );
+
+    for( __u32 __v{ 0 }; __v < __n; __v++ )
+      { __comp[__v] = __v; }
+
+    /** Сравнение ребер __a < __b, выходящих из вершин __va и __vb.
+     */
+    auto __less = [&]( __u32 __va, __u64 __a, __u32 __vb, __u64 __b )
+      {
+      __u32  __wa = __g.adj_weight( __va, __a );
+      __u32  __wb = __g.adj_weight( __vb, __b );
+      if( __wa != __wb )
+        { return __wa < __wb; }
+
+      __u32  __ta = __nbr[__a];
+      __u32  __tb = __nbr[__b];
+      __u32  __lo_a = __va < __ta ? __va : __ta;
+      __u32  __lo_b = __vb < __tb ? __vb : __tb;
+      if( __lo_a != __lo_b )
+        { return __lo_a < __lo_b; }
+
+      __u32  __hi_a = __va < __ta ? __ta : __va;
+      __u32  __hi_b = __vb < __tb ? __tb : __vb;
+      return __hi_a < __hi_b;
+      };
+
+    for( bool __merged{ true }; __merged; )
+      {
+      __merged = false;
+
+      __pool.parallel_for( 0, __n, [&]( __u64 __i, __u32 )
+        {
+        __u32  __v = static_cast<__u32>( __i );
+        __u64  __best{ __none };
+
+        for( __u64 __e = __off[__v]; __e < __off[__v + 1]; __e++ )
+          {
+          if( __comp[__nbr[__e]] != __comp[__v]
+              && ( __best == __none || __less( __v, __e, __v, __best ) ) )
+            { __best = __e; }
+          }
+
+        __best_edge[__v] = __best;
+        __best_vertex[__v].store( 0xFFFFFFFFu, std::memory_order_relaxed );
+        }, 256 );
+
+      __pool.parallel_for( 0, __n, [&]( __u64 __i, __u32 )
+        {
+        __u32  __v = static_cast<__u32>( __i );
+        if( __best_edge[__v] == __none )
+          { return; }
+
+        std::atomic<__u32>&  __slot = __best_vertex[__comp[__v]];
+        __u32                __cur  = __slot.load( std::memory_order_relaxed );
+
+        while( __cur == 0xFFFFFFFFu
+               || __less( __v, __best_edge[__v], __cur, __best_edge[__cur] ) )
+          {
+          if( __slot.compare_exchange_weak( __cur, __v,
+                                            std::memory_order_relaxed ) )
+            { break; }
+          }
+        } );
+
+      for( __u32 __c{ 0 }; __c < __n; __c++ )
+        {
+        __u32  __v = __best_vertex[__c].load( std::memory_order_relaxed );
+        if( __v == 0xFFFFFFFFu )
+          { continue; }
+
+        __u64  __e = __best_edge[__v];
+        if( __ds.unite( __v, __nbr[__e] ) )
+          {
+          __tree.push_back( { __v, __nbr[__e], __g.adj_weight( __v, __e ) } );
+          __merged = true;
+          }
+        }
+
+      for( __u32 __v{ 0 }; __v < __n; __v++ )
+        { __comp[__v] = __ds.find( __v ); }
+      }
+
+    return __tree;
+    }
+//--------------------------------------------------------------------
+// Параллельный алгоритм Борувки на временном пуле из __threads потоков.
+  inline auto
+  boruvka_parallel( const pcsr_view& __g,
+                    __u32 __threads = hardware_threads() ) -> std::vector<pedge>
+    {
+    ptask_pool  __pool( __threads );
+    return boruvka_parallel( __g, __pool );
+    }
+
+  } // namespace ptl
+
+#endif // __PTL_PMST_H__
@@ -14,6 +14,13 @@
 #if !defined( __PTL_PNODE_H__ )
 #define __PTL_PNODE_H__
 
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#include <new>
+#include <vector>
+
 namespace ptl
   {
 //////////////////////////////////////////////////////////////////////
@@ -32,6 +39,108 @@ namespace ptl
       pnode<_Tp>*  _M_next; // Указатель на адрес следующего узла списка.
 
     }; // class pnode
+//////////////////////////////////////////////////////////////////////
+// Пул узлов связанного списка.
+//
+// Память выделяется пластами (slab) по несколько узлов, каждый
+// следующий пласт вдвое больше предыдущего (до __max_slab узлов).
+// Освобожденные узлы попадают в список свободных и выдаются повторно,
+// поэтому при чередовании вставок и удалений обращений к operator new
+// нет. Память пластов возвращается только в деструкторе пула; к этому
+// моменту все узлы должны быть освобождены через destroy().
+//
+  template <typename _Tp>
+  class pnode_pool
+    {
+    private:
+      // Свободный узел хранит в своей памяти ссылку на следующий.
+      struct _Free
+        {
+        _Free*  _S_next;
+        };
+
+      static constexpr __u32  __first_slab = 16;
+      static constexpr __u32  __max_slab   = 4096;
+
+      std::vector<void*>  _M_slabs;              // Выделенные пласты
+      _Free*              _M_free{ nullptr };    // Список свободных узлов
+      pnode<_Tp>*         _M_cursor{ nullptr };  // Неразмеченная часть
+      pnode<_Tp>*         _M_limit{ nullptr };   // последнего пласта
+      __u32               _M_next_slab{ __first_slab };
+
+    public:
+      pnode_pool() = default;
+
+      pnode_pool( const pnode_pool& ) = delete;
+
+      pnode_pool&
+      operator=( const pnode_pool& ) = delete;
+
+      ~pnode_pool() noexcept
+        {
+        for( void* __slab : _M_slabs )
+          { ::operator delete( __slab ); }
+        }
+//--------------------------------------------------------------------
+// Создание узла со значением __data.
+      auto
+      create( const _Tp& __data ) -> pnode<_Tp>*
+        {
+        void*  __p;
+
+        if( _M_free != nullptr )
+          {
+          __p = _M_free;
+          _M_free = _M_free->_S_next;
+          }
+        else
+          {
+          if( _M_cursor == _M_limit )
+            {
+            /** Место в списке пластов занимается до выделения: если
+             *  бросит push_back(), пласт еще не выделен; если бросит
+             *  operator new, в списке остается nullptr, который
+             *  деструктор освобождает без последствий.
+             */
+            _M_slabs.push_back( nullptr );
+            _M_slabs.back() = ::operator new( sizeof( pnode<_Tp> ) * _M_next_slab );
+
+            _M_cursor = static_cast<pnode<_Tp>*>( _M_slabs.back() );
+            _M_limit  = _M_cursor + _M_next_slab;
+
+            if( _M_next_slab < __max_slab )
+              { _M_next_slab *= 2; }
+            }
+          __p = _M_cursor++;
+          }
+
+        try
+          { return new( __p ) pnode<_Tp>( __data ); }
+        catch( ... )
+          {
+          release( __p );
+          throw;
+          }
+        }
+//--------------------------------------------------------------------
+// Уничтожение узла и возврат его памяти в пул.
+      auto
+      destroy( pnode<_Tp>* __node ) -> void
+        {
+        __node->~pnode<_Tp>();
+        release( __node );
+        }
+
+    private:
+      auto
+      release( void* __p ) -> void
+        {
+        _Free*  __f = static_cast<_Free*>( __p );
+        __f->_S_next = _M_free;
+        _M_free = __f;
+        }
+
+    }; // class pnode_pool
   } // namespace ptl
 
 #endif // __PTL_PNODE_H__
\ No newline at end of file
@@ -0,0 +1,279 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для параллельного выполнения циклов.
+ */
+
+/**
+ *  (PTL) Patriarch library : pparallel.h
+ */
+
+#pragma once
+#if !defined( __PTL_PPARALLEL_H__ )
+#define __PTL_PPARALLEL_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Функции:
+ *   - hardware_threads() - количество аппаратных потоков
+ *   - cpu_relax() - пауза в цикле активного ожидания
+ *   - parallel_for() - параллельный цикл по диапазону индексов
+ *
+ * Классы:
+ *   - ptask_pool - пул потоков для многофазных алгоритмов, где
+ *     создавать потоки на каждую фазу слишком дорого
+ *
+ * @code
+ *   ptl::parallel_for( 0, n, 8, [&]( ptl::__u64 i ) { out[i] = f( i ); } );
+ *
+ *   ptl::ptask_pool pool( 8 );
+ *   pool.parallel_for( 0, n, [&]( ptl::__u64 i, ptl::__u32 worker )
+ *     { local[worker] += f( i ); } );
+ * @endcode
+ */
+
+namespace ptl
+  {
+  // Размер строки кэша. Данные, которые пишут разные потоки,
+  // разносятся по разным строкам, чтобы избежать ложного разделения.
+  constexpr __u32  cache_line_size = 64;
+//--------------------------------------------------------------------
+// Подсказка процессору внутри цикла активного ожидания: снижает
+// потребление и не мешает соседнему гиперпотоку.
+  inline auto
+  cpu_relax() -> void
+    {
+#if defined( __x86_64__ ) || defined( __i386__ )
+    __builtin_ia32_pause();
+#elif defined( __aarch64__ )
+    asm volatile( "yield" );
+#endif
+    }
+//--------------------------------------------------------------------
+// Количество аппаратных потоков (не меньше 1).
+  inline auto
+  hardware_threads() -> __u32
+    {
+    __u32  __n = std::thread::hardware_concurrency();
+    return __n == 0 ? 1 : __n;
+    }
+//--------------------------------------------------------------------
+// Параллельный цикл по индексам [__begin, __end).
+// Индексы раздаются потокам порциями по __grain через общий атомарный
+// счетчик, поэтому неравномерная работа (например, вершины разной
+// степени) распределяется динамически. При __threads <= 1 цикл
+// выполняется в вызывающем потоке.
+  template <typename _Func>
+    auto
+    parallel_for( __u64 __begin, __u64 __end, __u32 __threads, _Func __f,
+                  __u64 __grain = 1024 ) -> void
+      {
+      if( __begin >= __end )
+        { return; }
+
+      if( __threads <= 1 || __end - __begin <= __grain )
+        {
+        for( __u64 __i{ __begin }; __i < __end; __i++ )
+          { __f( __i ); }
+        return;
+        }
+
+      std::atomic<__u64>  __next{ __begin };
+
+      auto __work = [&]()
+        {
+        for( ;; )
+          {
+          __u64  __lo = __next.fetch_add( __grain, std::memory_order_relaxed );
+          if( __lo >= __end )
+            { break; }
+
+          __u64  __hi = __end - __lo < __grain ? __end : __lo + __grain;
+          for( __u64 __i{ __lo }; __i < __hi; __i++ )
+            { __f( __i ); }
+          }
+        };
+
+      std::vector<std::thread>  __pool;
+      __pool.reserve( __threads - 1 );
+
+      for( __u32 __t{ 1 }; __t < __threads; __t++ )
+        { __pool.emplace_back( __work ); }
+
+      __work();
+
+      for( std::thread& __th : __pool )
+        { __th.join(); }
+      }
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Пул потоков с разовой раздачей задачи всем потокам.
+   * Вызывающий поток участвует в работе как поток номер 0, поэтому
+   * пул из N потоков создает N-1 рабочих потоков.
+   *
+   * Методы:
+   *   - size() - количество потоков, включая вызывающий
+   *   - run() - выполнение f( worker ) на каждом потоке с ожиданием
+   *   - parallel_for() - параллельный цикл f( index, worker )
+   */
+  class ptask_pool
+    {
+    private:
+      // Задача без стирания типа через std::function: указатель на
+      // функцию-переходник и на сам функтор.
+      typedef void ( *_Call )( void*, __u32 );
+
+      std::vector<std::thread>  _M_workers;
+      std::mutex                _M_mutex;
+      std::condition_variable   _M_wake;            // Новая задача или останов
+      std::condition_variable   _M_done;            // Все потоки закончили
+      _Call                     _M_call{ nullptr };
+      void*                     _M_ctx{ nullptr };
+      __u64                     _M_generation{ 0 }; // Номер текущей задачи
+      __u32                     _M_running{ 0 };    // Еще работающих потоков
+      bool                      _M_stop{ false };
+
+      auto
+      worker_loop( __u32 __id ) -> void
+        {
+        __u64  __seen{ 0 };
+
+        for( ;; )
+          {
+          _Call  __call;
+          void*  __ctx;
+
+            {
+            std::unique_lock<std::mutex>  __lock( _M_mutex );
+            _M_wake.wait( __lock, [&]
+              { return _M_stop || _M_generation != __seen; } );
+
+            if( _M_stop )
+              { return; }
+
+            __seen = _M_generation;
+            __call = _M_call;
+            __ctx  = _M_ctx;
+            }
+
+          __call( __ctx, __id );
+
+            {
+            std::lock_guard<std::mutex>  __lock( _M_mutex );
+            if( --_M_running == 0 )
+              { _M_done.notify_one(); }
+            }
+          }
+        }
+
+    public:
+      explicit
+      ptask_pool( __u32 __threads = hardware_threads() )
+        {
+        for( __u32 __t{ 1 }; __t < __threads; __t++ )
+          { _M_workers.emplace_back( &ptask_pool::worker_loop, this, __t ); }
+        }
+
+      ptask_pool( const ptask_pool& ) = delete;
+
+      ptask_pool&
+      operator=( const ptask_pool& ) = delete;
+
+      ~ptask_pool() noexcept
+        {
+          {
+          std::lock_guard<std::mutex>  __lock( _M_mutex );
+          _M_stop = true;
+          }
+        _M_wake.notify_all();
+
+        for( std::thread& __th : _M_workers )
+          { __th.join(); }
+        }
+//--------------------------------------------------------------------
+// Количество потоков, включая вызывающий.
+      auto
+      size() const -> __u32
+        { return static_cast<__u32>( _M_workers.size() ) + 1; }
+//--------------------------------------------------------------------
+// Выполнение __f( worker ) на каждом потоке пула.
+// Возврат - после того, как все потоки закончили.
+      template <typename _Func>
+        auto
+        run( _Func& __f ) -> void
+          {
+          if( _M_workers.empty() )
+            {
+            __f( 0u );
+            return;
+            }
+
+            {
+            std::lock_guard<std::mutex>  __lock( _M_mutex );
+            _M_call = []( void* __ctx, __u32 __id )
+              { ( *static_cast<_Func*>( __ctx ) )( __id ); };
+            _M_ctx     = &__f;
+            _M_running = static_cast<__u32>( _M_workers.size() );
+            _M_generation++;
+            }
+          _M_wake.notify_all();
+
+          __f( 0u );
+
+          std::unique_lock<std::mutex>  __lock( _M_mutex );
+          _M_done.wait( __lock, [&] { return _M_running == 0; } );
+          }
+//--------------------------------------------------------------------
+// Параллельный цикл по индексам [__begin, __end).
+// __f( index, worker ) получает номер потока, что позволяет вести
+// локальные для потока буферы без синхронизации.
+      template <typename _Func>
+        auto
+        parallel_for( __u64 __begin, __u64 __end, _Func __f,
+                      __u64 __grain = 1024 ) -> void
+          {
+          if( __begin >= __end )
+            { return; }
+
+          if( _M_workers.empty() || __end - __begin <= __grain )
+            {
+            for( __u64 __i{ __begin }; __i < __end; __i++ )
+              { __f( __i, 0u ); }
+            return;
+            }
+
+          std::atomic<__u64>  __next{ __begin };
+
+          auto __work = [&]( __u32 __id )
+            {
+            for( ;; )
+              {
+              __u64  __lo = __next.fetch_add( __grain, std::memory_order_relaxed );
+              if( __lo >= __end )
+                { break; }
+
+              __u64  __hi = __end - __lo < __grain ? __end : __lo + __grain;
+              for( __u64 __i{ __lo }; __i < __hi; __i++ )
+                { __f( __i, __id ); }
+              }
+            };
+
+          run( __work );
+          }
+
+    }; // class ptask_pool
+
+  } // namespace ptl
+
+#endif // __PTL_PPARALLEL_H__
@@ -0,0 +1,545 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для очередей с приоритетом.
+ */
+
+/**
+ *  (PTL) Patriarch library : ppriority_queue.h
+ */
+
+#pragma once
+#if !defined( __PTL_PPRIORITY_QUEUE_H__ )
+#define __PTL_PPRIORITY_QUEUE_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#if !defined( __PTL_PEXCEPT_H__ )
+#include "pexcept.h"
+#endif
+
+#if !defined( __PTL_PVECTOR_H__ )
+#include "pvector.h"
+#endif
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+/*
+ * Очереди с приоритетом на d-арной куче. На вершине кучи - наименьший
+ * по _Compare элемент (для std::less - минимальный). Арность _Arity
+ * задает число детей узла: куча при большей арности ниже, извлечение
+ * сравнивает больше детей, но дети лежат подряд в одной-двух строках
+ * кэша; 4 - хороший выбор по умолчанию.
+ *
+ * Классы:
+ *   - ppriority_queue - куча элементов
+ *   - pindexed_priority_queue - куча номеров 0..n-1 с ключами,
+ *     с изменением ключа и удалением по номеру за O(log n)
+ *   - pradix_heap - поразрядная куча для монотонных целых ключей
+ *
+ * Методы ppriority_queue:
+ *   - push(), emplace() - добавление элемента
+ *   - top() - ссылка на элемент вершины
+ *   - pop() - извлечение элемента вершины перемещением
+ *   - assign() - построение кучи из pvector за O(n)
+ *   - size(), empty(), clear(), reserve()
+ *
+ * Методы pindexed_priority_queue:
+ *   - push() - добавление номера с ключом
+ *   - decrease_key() - уменьшение ключа номера
+ *   - update() - изменение ключа номера в любую сторону
+ *   - erase() - удаление номера
+ *   - contains(), key() - наличие и ключ номера
+ *   - top(), top_key(), pop() - номер вершины, его ключ, извлечение
+ *   - size(), empty(), clear()
+ *
+ * Методы pradix_heap:
+ *   - push() - добавление пары (ключ, значение); ключ не меньше
+ *     последнего извлеченного
+ *   - pop() - извлечение пары с наименьшим ключом
+ *   - top_key(), size(), empty(), clear()
+ *
+ * @code
+ *   ptl::pindexed_priority_queue<ptl::__u64> heap( n );
+ *   heap.push( source, 0 );
+ *   while( !heap.empty() )
+ *     {
+ *     ptl::__u32 v = heap.pop();
+ *     ...
+ *     heap.contains( w ) ? heap.decrease_key( w, d ) : heap.push( w, d );
+ *     }
+ * @endcode
+ */
+
+namespace ptl
+  {
+//////////////////////////////////////////////////////////////////////
+  template <typename _Tp, typename _Compare = std::less<_Tp>, __u32 _Arity = 4>
+  class ppriority_queue
+    {
+      static_assert( _Arity >= 2, "Арность кучи должна быть не меньше 2." );
+
+    private:
+      std::vector<_Tp>  _M_heap;
+      _Compare          _M_less;
+
+      auto
+      sift_up( __u64 __i ) -> void
+        {
+        _Tp  __x = std::move( _M_heap[__i] );
+
+        while( __i > 0 )
+          {
+          __u64  __parent = ( __i - 1 ) / _Arity;
+          if( !_M_less( __x, _M_heap[__parent] ) )
+            { break; }
+          _M_heap[__i] = std::move( _M_heap[__parent] );
+          __i = __parent;
+          }
+
+        _M_heap[__i] = std::move( __x );
+        }
+//--------------------------------------------------------------------
+      auto
+      sift_down( __u64 __i ) -> void
+        {
+        __u64  __n = _M_heap.size();
+        _Tp    __x = std::move( _M_heap[__i] );
+
+        for( ;; )
+          {
+          __u64  __first = __i * _Arity + 1;
+          if( __first >= __n )
+            { break; }
+
+          __u64  __last = __first + _Arity < __n ? __first + _Arity : __n;
+          __u64  __best = __first;
+          for( __u64 __c = __first + 1; __c < __last; __c++ )
+            {
+            if( _M_less( _M_heap[__c], _M_heap[__best] ) )
+              { __best = __c; }
+            }
+
+          if( !_M_less( _M_heap[__best], __x ) )
+            { break; }
+          _M_heap[__i] = std::move( _M_heap[__best] );
+          __i = __best;
+          }
+
+        _M_heap[__i] = std::move( __x );
+        }
+
+    public:
+      explicit
+      ppriority_queue( const _Compare& __less = _Compare() )
+        : _M_less( __less )
+        { }
+
+      /** Построение кучи из элементов __items за O(n).
+       */
+      explicit
+      ppriority_queue( pvector<_Tp>& __items, const _Compare& __less = _Compare() )
+        : _M_less( __less )
+        { assign( __items ); }
+//--------------------------------------------------------------------
+// Замена содержимого элементами __items. Куча строится просеиванием
+// вниз от последнего внутреннего узла к корню за O(n).
+      auto
+      assign( pvector<_Tp>& __items ) -> void
+        {
+        _M_heap.clear();
+        _M_heap.reserve( __items.size() );
+        for( __u32 __i{ 0 }; __i < __items.size(); __i++ )
+          { _M_heap.push_back( __items[__i] ); }
+
+        for( __u64 __i = _M_heap.size() / _Arity + 1; __i-- > 0; )
+          {
+          if( __i < _M_heap.size() )
+            { sift_down( __i ); }
+          }
+        }
+//--------------------------------------------------------------------
+      auto
+      push( const _Tp& __data ) -> void
+        {
+        _M_heap.push_back( __data );
+        sift_up( _M_heap.size() - 1 );
+        }
+//--------------------------------------------------------------------
+      auto
+      push( _Tp&& __data ) -> void
+        {
+        _M_heap.push_back( std::move( __data ) );
+        sift_up( _M_heap.size() - 1 );
+        }
+//--------------------------------------------------------------------
+      template <typename... _Args>
+        auto
+        emplace( _Args&&... __args ) -> void
+          {
+          _M_heap.emplace_back( std::forward<_Args>( __args )... );
+          sift_up( _M_heap.size() - 1 );
+          }
+//--------------------------------------------------------------------
+      auto
+      top() const -> const _Tp&
+        {
+        if( _M_heap.empty() )
+          { throw pexception( "W: Очередь пуста." ); }
+        return _M_heap.front();
+        }
+//--------------------------------------------------------------------
+      auto
+      pop() -> _Tp
+        {
+        if( _M_heap.empty() )
+          { throw pexception( "W: Очередь пуста." ); }
+
+        _Tp  __result = std::move( _M_heap.front() );
+
+        if( _M_heap.size() > 1 )
+          {
+          _M_heap.front() = std::move( _M_heap.back() );
+          _M_heap.pop_back();
+          sift_down( 0 );
+          }
+        else
+          { _M_heap.pop_back(); }
+
+        return __result;
+        }
+//--------------------------------------------------------------------
+      auto
+      size() const -> __u64
+        { return _M_heap.size(); }
+//--------------------------------------------------------------------
+      auto
+      empty() const -> bool
+        { return _M_heap.empty(); }
+//--------------------------------------------------------------------
+      auto
+      clear() -> void
+        { _M_heap.clear(); }
+//--------------------------------------------------------------------
+      auto
+      reserve( __u64 __count ) -> void
+        { _M_heap.reserve( __count ); }
+
+    }; // class ppriority_queue
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Индексированная куча: элементы - номера 0..capacity-1 с ключами.
+   * Для каждого номера хранится его позиция в куче, поэтому ключ
+   * можно изменить или номер удалить, не разыскивая его.
+   */
+  template <typename _Key, typename _Compare = std::less<_Key>, __u32 _Arity = 4>
+  class pindexed_priority_queue
+    {
+      static_assert( _Arity >= 2, "Арность кучи должна быть не меньше 2." );
+
+    private:
+      static constexpr __u32  __absent = 0xFFFFFFFFu;
+
+      std::vector<__u32>  _M_heap; // Номера в порядке кучи
+      std::vector<__u32>  _M_pos;  // Позиция номера в куче или __absent
+      std::vector<_Key>   _M_key;  // Ключ номера
+      _Compare            _M_less;
+
+      auto
+      place( __u32 __i, __u32 __id ) -> void
+        {
+        _M_heap[__i] = __id;
+        _M_pos[__id] = __i;
+        }
+//--------------------------------------------------------------------
+      auto
+      sift_up( __u32 __i ) -> void
+        {
+        __u32  __id = _M_heap[__i];
+
+        while( __i > 0 )
+          {
+          __u32  __parent = ( __i - 1 ) / _Arity;
+          if( !_M_less( _M_key[__id], _M_key[_M_heap[__parent]] ) )
+            { break; }
+          place( __i, _M_heap[__parent] );
+          __i = __parent;
+          }
+
+        place( __i, __id );
+        }
+//--------------------------------------------------------------------
+      auto
+      sift_down( __u32 __i ) -> void
+        {
+        __u32  __n  = static_cast<__u32>( _M_heap.size() );
+        __u32  __id = _M_heap[__i];
+
+        for( ;; )
+          {
+          __u64  __first = static_cast<__u64>( __i ) * _Arity + 1;
+          if( __first >= __n )
+            { break; }
+
+          __u32  __last = __first + _Arity < __n ? static_cast<__u32>( __first + _Arity ) : __n;
+          __u32  __best = static_cast<__u32>( __first );
+          for( __u32 __c = __best + 1; __c < __last; __c++ )
+            {
+            if( _M_less( _M_key[_M_heap[__c]], _M_key[_M_heap[__best]] ) )
+              { __best = __c; }
+            }
+
+          if( !_M_less( _M_key[_M_heap[__best]], _M_key[__id] ) )
+            { break; }
+          place( __i, _M_heap[__best] );
+          __i = __best;
+          }
+
+        place( __i, __id );
+        }
+//--------------------------------------------------------------------
+      auto
+      check( __u32 __id ) const -> void
+        {
+        if( !contains( __id ) )
+          { throw pexception( "E: Такого элемента в очереди нет." ); }
+        }
+
+    public:
+      /** Очередь для номеров 0..__capacity-1.
+       */
+      explicit
+      pindexed_priority_queue( __u32 __capacity = 0,
+                               const _Compare& __less = _Compare() )
+        : _M_pos( __capacity, __absent ), _M_key( __capacity ), _M_less( __less )
+        { }
+//--------------------------------------------------------------------
+// Расширение диапазона номеров до __capacity.
+      auto
+      resize( __u32 __capacity ) -> void
+        {
+        if( __capacity < _M_pos.size() )
+          { throw pexception( "E: Диапазон номеров нельзя уменьшить." ); }
+        _M_pos.resize( __capacity, __absent );
+        _M_key.resize( __capacity );
+        }
+//--------------------------------------------------------------------
+      auto
+      contains( __u32 __id ) const -> bool
+        { return __id < _M_pos.size() && _M_pos[__id] != __absent; }
+//--------------------------------------------------------------------
+      auto
+      key( __u32 __id ) const -> const _Key&
+        {
+        check( __id );
+        return _M_key[__id];
+        }
+//--------------------------------------------------------------------
+// Добавление номера __id с ключом __key.
+      auto
+      push( __u32 __id, const _Key& __key ) -> void
+        {
+        if( __id >= _M_pos.size() )
+          { throw pexception( "E: Номер вне диапазона очереди." ); }
+        if( _M_pos[__id] != __absent )
+          { throw pexception( "E: Элемент уже в очереди." ); }
+
+        _M_key[__id] = __key;
+        _M_heap.push_back( __id );
+        sift_up( static_cast<__u32>( _M_heap.size() - 1 ) );
+        }
+//--------------------------------------------------------------------
+// Уменьшение ключа (продвижение к вершине). Ключ не должен
+// становиться больше текущего.
+      auto
+      decrease_key( __u32 __id, const _Key& __key ) -> void
+        {
+        check( __id );
+        if( _M_less( _M_key[__id], __key ) )
+          { throw pexception( "E: Новый ключ больше текущего." ); }
+
+        _M_key[__id] = __key;
+        sift_up( _M_pos[__id] );
+        }
+//--------------------------------------------------------------------
+// Изменение ключа в любую сторону.
+      auto
+      update( __u32 __id, const _Key& __key ) -> void
+        {
+        check( __id );
+
+        bool  __up = _M_less( __key, _M_key[__id] );
+        _M_key[__id] = __key;
+
+        if( __up )
+          { sift_up( _M_pos[__id] ); }
+        else
+          { sift_down( _M_pos[__id] ); }
+        }
+//--------------------------------------------------------------------
+// Удаление номера: на его место встает последний элемент кучи и
+// просеивается в нужную сторону.
+      auto
+      erase( __u32 __id ) -> void
+        {
+        check( __id );
+
+        __u32  __i    = _M_pos[__id];
+        __u32  __last = _M_heap.back();
+
+        _M_heap.pop_back();
+        _M_pos[__id] = __absent;
+
+        if( __last == __id )
+          { return; }
+
+        place( __i, __last );
+        if( __i > 0 && _M_less( _M_key[__last], _M_key[_M_heap[( __i - 1 ) / _Arity]] ) )
+          { sift_up( __i ); }
+        else
+          { sift_down( __i ); }
+        }
+//--------------------------------------------------------------------
+      auto
+      top() const -> __u32
+        {
+        if( _M_heap.empty() )
+          { throw pexception( "W: Очередь пуста." ); }
+        return _M_heap.front();
+        }
+//--------------------------------------------------------------------
+      auto
+      top_key() const -> const _Key&
+        { return _M_key[top()]; }
+//--------------------------------------------------------------------
+// Извлечение номера вершины.
+      auto
+      pop() -> __u32
+        {
+        __u32  __id = top();
+        erase( __id );
+        return __id;
+        }
+//--------------------------------------------------------------------
+      auto
+      size() const -> __u32
+        { return static_cast<__u32>( _M_heap.size() ); }
+//--------------------------------------------------------------------
+      auto
+      empty() const -> bool
+        { return _M_heap.empty(); }
+//--------------------------------------------------------------------
+      auto
+      clear() -> void
+        {
+        for( __u32 __id : _M_heap )
+          { _M_pos[__id] = __absent; }
+        _M_heap.clear();
+        }
+
+    }; // class pindexed_priority_queue
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Поразрядная куча (radix heap) для монотонных ключей __u64: ключ
+   * добавляемого элемента не меньше ключа последнего извлеченного,
+   * как в алгоритме Дейкстры. Элемент лежит в корзине номер
+   * "старший различающийся бит ключа и последнего извлеченного";
+   * при извлечении корзина с наименьшими ключами раскладывается по
+   * младшим корзинам. Каждый элемент переносится не больше 64 раз,
+   * поэтому извлечение стоит O(1) амортизированно плюс O(64).
+   */
+  template <typename _Val = __u32>
+  class pradix_heap
+    {
+    private:
+      typedef std::pair<__u64, _Val>  _Entry;
+
+      std::vector<_Entry>  _M_bucket[65];
+      __u64                _M_last{ 0 }; // Последний извлеченный ключ
+      __u64                _M_size{ 0 };
+
+      auto
+      bucket( __u64 __key ) const -> __u32
+        { return __key == _M_last ? 0 : 64 - __builtin_clzll( __key ^ _M_last ); }
+
+    public:
+      pradix_heap() = default;
+//--------------------------------------------------------------------
+      auto
+      push( __u64 __key, const _Val& __val ) -> void
+        {
+        if( __key < _M_last )
+          { throw pexception( "E: Ключ меньше последнего извлеченного." ); }
+
+        _M_bucket[bucket( __key )].emplace_back( __key, __val );
+        _M_size++;
+        }
+//--------------------------------------------------------------------
+// Ключ наименьшего элемента. После вызова он лежит в корзине 0.
+      auto
+      top_key() -> __u64
+        {
+        if( _M_size == 0 )
+          { throw pexception( "W: Очередь пуста." ); }
+
+        if( _M_bucket[0].empty() )
+          {
+          __u32  __i{ 1 };
+          while( _M_bucket[__i].empty() )
+            { __i++; }
+
+          __u64  __min = _M_bucket[__i].front().first;
+          for( const _Entry& __e : _M_bucket[__i] )
+            { __min = __e.first < __min ? __e.first : __min; }
+
+          _M_last = __min;
+
+          std::vector<_Entry>  __moved;
+          __moved.swap( _M_bucket[__i] );
+          for( _Entry& __e : __moved )
+            { _M_bucket[bucket( __e.first )].push_back( std::move( __e ) ); }
+          }
+
+        return _M_last;
+        }
+//--------------------------------------------------------------------
+// Извлечение пары с наименьшим ключом.
+      auto
+      pop() -> _Entry
+        {
+        top_key();
+
+        _Entry  __e = std::move( _M_bucket[0].back() );
+        _M_bucket[0].pop_back();
+        _M_size--;
+        return __e;
+        }
+//--------------------------------------------------------------------
+      auto
+      size() const -> __u64
+        { return _M_size; }
+//--------------------------------------------------------------------
+      auto
+      empty() const -> bool
+        { return _M_size == 0; }
+//--------------------------------------------------------------------
+      auto
+      clear() -> void
+        {
+        for( std::vector<_Entry>& __b : _M_bucket )
+          { __b.clear(); }
+        _M_last = 0;
+        _M_size = 0;
+        }
+
+    }; // class pradix_heap
+
+  } // namespace ptl
+
+#endif // __PTL_PPRIORITY_QUEUE_H__
@@ -23,6 +23,7 @@
 #endif
 
 #include <iostream>
+#include <utility>
 
 /*
  * Очередь. 
@@ -30,10 +31,16 @@
  * Методы:
  *   - is_empty() - проверка, пуста ли очередь (true - пуста, false - нет)
  *   - en_queue() - добавление элемента в конец очереди
- *   - de_queue() - удаление элемента с конца очереди
+ *   - de_queue() - извлечение элемента из начала очереди (возвращается
+ *                  перемещением)
  *   - peek() - просмотр элемента начала очереди
  *   - show() - вывод содержимого очереди через пробел
  *
+ * Очередь не синхронизирована. Для передачи данных между потоками
+ * предназначены pmpmc_queue из pmpmc_queue.h и, если потребителям
+ * нужно ждать данных, pblocking_queue из pblocking_queue.h.
+ * Двусторонняя очередь на непрерывном массиве - pdeque из pdeque.h.
+ *
  * @code
  *   ptl::pqueue<ptl::__s32> queue;
  *   queue. ...;
@@ -60,8 +67,20 @@ namespace ptl
         : _M_front( nullptr ), _M_rear( nullptr )
         { }
 
+      pqueue( const pqueue& ) = delete;
+
+      pqueue&
+      operator=( const pqueue& ) = delete;
+
       ~pqueue() noexcept
-        { }
+        {
+        while( _M_front != nullptr )
+          {
+          pnode<_Tp>* temp = _M_front;
+          _M_front = _M_front->_M_next;
+          delete temp;
+          }
+        }
 //--------------------------------------------------------------------
     auto
     is_empty() -> bool
@@ -85,7 +104,7 @@ namespace ptl
       }
 //--------------------------------------------------------------------
     auto
-    de_queue() -> void
+    de_queue() -> _Tp
       {
       if( is_empty() )
         throw 
@@ -93,6 +112,7 @@ namespace ptl
 
       // Удаляем первый узел в очереди.
       pnode<_Tp>* temp = _M_front;
+      _Tp  __result( std::move( temp->_M_data ) );
       _M_front = _M_front->_M_next;
 
       // Если очередь пуста, необходимо обновить значение _M_rear.
@@ -100,6 +120,7 @@ namespace ptl
         _M_rear = nullptr;
 
       delete temp;
+      return __result;
       }
 //--------------------------------------------------------------------
     auto
@@ -0,0 +1,371 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для поиска кратчайшего пути между двумя
+ * вершинами графа.
+ */
+
+/**
+ *  (PTL) Patriarch library : psearch.h
+ */
+
+#pragma once
+#if !defined( __PTL_PSEARCH_H__ )
+#define __PTL_PSEARCH_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#if !defined( __PTL_PSSSP_H__ )
+#include "psssp.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <tuple>
+#include <vector>
+
+/*
+ * Поиск кратчайшего пути от вершины до вершины. В отличие от
+ * dijkstra() поиск прекращается, как только путь до цели доказан,
+ * а не после обхода всего графа.
+ *
+ * Функции:
+ *   - astar() - A* с подключаемой эвристикой
+ *   - bidirectional_dijkstra() - двунаправленный алгоритм Дейкстры
+ *
+ * Классы:
+ *   - ppath_result - найденный путь, его стоимость и количество
+ *     окончательно обработанных вершин
+ *   - psearch_space - рабочие массивы поиска, переиспользуемые между
+ *     запросами (сброс стоит O(затронутых вершин), а не O(n))
+ *   - pzero_heuristic - нулевая эвристика (A* вырождается в Дейкстру)
+ *   - peuclidean_heuristic - евклидово расстояние по координатам
+ *
+ * Эвристика - функтор h( v, target ) -> __u64, не превышающий
+ * истинную стоимость пути от v до target.
+ *
+ * @code
+ *   ptl::peuclidean_heuristic  h( xs, ys );
+ *   ptl::ppath_result  r = ptl::astar( graph, from, to, h );
+ *   if( r._S_found ) { use( r._S_cost, r._S_path ); }
+ * @endcode
+ */
+
+namespace ptl
+  {
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Результат поиска пути.
+   */
+  struct ppath_result
+    {
+    bool                _S_found{ false };               // путь существует
+    __u64               _S_cost{ unreachable_distance }; // стоимость пути
+    std::vector<__u32>  _S_path;                         // вершины пути
+    __u64               _S_settled{ 0 };                 // обработано вершин
+    };
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Рабочие массивы одного направления поиска.
+   */
+  class psearch_space
+    {
+    private:
+      std::vector<__u64>  _M_dist;    // Расстояние от начала поиска
+      std::vector<__u32>  _M_parent;  // Предыдущая вершина пути
+      std::vector<__u32>  _M_touched; // Вершины с измененным расстоянием
+
+    public:
+      psearch_space() = default;
+//--------------------------------------------------------------------
+// Подготовка к новому запросу на графе из __n вершин.
+      auto
+      reset( __u32 __n ) -> void
+        {
+        if( _M_dist.size() != __n )
+          {
+          _M_dist.assign( __n, unreachable_distance );
+          _M_parent.assign( __n, 0 );
+          }
+        else
+          {
+          for( __u32 __v : _M_touched )
+            { _M_dist[__v] = unreachable_distance; }
+          }
+        _M_touched.clear();
+        }
+//--------------------------------------------------------------------
+      auto
+      dist( __u32 __v ) const -> __u64
+        { return _M_dist[__v]; }
+//--------------------------------------------------------------------
+      auto
+      parent( __u32 __v ) const -> __u32
+        { return _M_parent[__v]; }
+//--------------------------------------------------------------------
+// Установка расстояния и предыдущей вершины.
+      auto
+      set( __u32 __v, __u64 __d, __u32 __parent ) -> void
+        {
+        if( _M_dist[__v] == unreachable_distance )
+          { _M_touched.push_back( __v ); }
+        _M_dist[__v]   = __d;
+        _M_parent[__v] = __parent;
+        }
+
+    }; // class psearch_space
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Нулевая эвристика.
+   */
+  struct pzero_heuristic
+    {
+    auto
+    operator()( __u32, __u32 ) const -> __u64
+      { return 0; }
+    };
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Евклидова эвристика по координатам вершин.
+   * __scale переводит расстояние в единицы весов ребер; для
+   * допустимости вес ребра должен быть не меньше длины ребра,
+   * умноженной на __scale.
+   */
+  struct peuclidean_heuristic
+    {
+    const double*  _M_x;
+    const double*  _M_y;
+    double         _M_scale;
+
+    peuclidean_heuristic( const double* __x, const double* __y,
+                          double __scale = 1.0 )
+      : _M_x( __x ), _M_y( __y ), _M_scale( __scale )
+      { }
+
+    auto
+    operator()( __u32 __v, __u32 __target ) const -> __u64
+      {
+      double  __dx = _M_x[__v] - _M_x[__target];
+      double  __dy = _M_y[__v] - _M_y[__target];
+      return static_cast<__u64>( _M_scale * std::sqrt( __dx * __dx + __dy * __dy ) );
+      }
+    };
+
+  namespace __detail
+    {
+//--------------------------------------------------------------------
+// Восстановление пути от начала поиска до __v по предкам.
+    inline auto
+    unwind_path( const psearch_space& __s, __u32 __origin, __u32 __v,
+                 std::vector<__u32>& __out ) -> void
+      {
+      __u64  __from = __out.size();
+
+      for( ;; )
+        {
+        __out.push_back( __v );
+        if( __v == __origin )
+          { break; }
+        __v = __s.parent( __v );
+        }
+
+      std::reverse( __out.begin() + __from, __out.end() );
+      }
+    } // namespace __detail
+//--------------------------------------------------------------------
+// Поиск A*. Вершины извлекаются по f = g + h( v, target ); при
+// допустимой эвристике первое извлечение цели дает кратчайший путь.
+// Запись кучи хранит g, поэтому устаревшие записи распознаются без
+// повторного вычисления эвристики.
+  template <typename _Graph, typename _Heuristic>
+    auto
+    astar( const _Graph& __g, __u32 __source, __u32 __target,
+           _Heuristic __h, psearch_space& __space ) -> ppath_result
+      {
+      typedef std::tuple<__u64, __u64, __u32>  _Entry; // f, g, вершина
+
+      ppath_result  __result;
+      std::priority_queue<_Entry, std::vector<_Entry>,
+                          std::greater<_Entry>>  __heap;
+
+      __space.reset( __g.vertex_bound() );
+      __space.set( __source, 0, __source );
+      __heap.push( _Entry( __h( __source, __target ), 0, __source ) );
+
+      while( !__heap.empty() )
+        {
+        __u64  __gv = std::get<1>( __heap.top() );
+        __u32  __v  = std::get<2>( __heap.top() );
+        __heap.pop();
+
+        if( __gv != __space.dist( __v ) )
+          { continue; }
+
+        __result._S_settled++;
+
+        if( __v == __target )
+          {
+          __result._S_found = true;
+          __result._S_cost  = __gv;
+          __detail::unwind_path( __space, __source, __target, __result._S_path );
+          break;
+          }
+
+        for( auto __c = __g.adj_begin( __v );
+             __c != __g.adj_end( __v );
+             __c = __g.adj_next( __v, __c ) )
+          {
+          __u32  __w  = __g.adj_target( __v, __c );
+          __u64  __nd = __gv + __g.adj_weight( __v, __c );
+
+          if( __nd < __space.dist( __w ) )
+            {
+            __space.set( __w, __nd, __v );
+            __heap.push( _Entry( __nd + __h( __w, __target ), __nd, __w ) );
+            }
+          }
+        }
+
+      return __result;
+      }
+//--------------------------------------------------------------------
+// Поиск A* с временными рабочими массивами.
+  template <typename _Graph, typename _Heuristic>
+    auto
+    astar( const _Graph& __g, __u32 __source, __u32 __target,
+           _Heuristic __h ) -> ppath_result
+      {
+      psearch_space  __space;
+      return astar( __g, __source, __target, __h, __space );
+      }
+//--------------------------------------------------------------------
+// Двунаправленный алгоритм Дейкстры.
+// Прямой поиск идет от __source по __g, обратный - от __target по
+// обращенному графу __rg (для неориентированного графа это тот же
+// граф). Каждый шаг расширяет сторону с меньшей вершиной кучи.
+// Лучшая стоимость встречи __best обновляется на каждом ребре в
+// вершину, уже достигнутую другой стороной; поиск прекращается, как
+// только сумма вершин куч не меньше __best.
+  template <typename _Graph, typename _RGraph>
+    auto
+    bidirectional_dijkstra( const _Graph& __g, const _RGraph& __rg,
+                            __u32 __source, __u32 __target,
+                            psearch_space& __fwd, psearch_space& __bwd )
+      -> ppath_result
+      {
+      typedef std::pair<__u64, __u32>  _Entry; // расстояние, вершина
+      typedef std::priority_queue<_Entry, std::vector<_Entry>,
+                                  std::greater<_Entry>>  _Heap;
+
+      ppath_result  __result;
+      _Heap         __fheap;
+      _Heap         __bheap;
+      __u64         __best{ unreachable_distance };
+      __u32         __meet{ __source };
+
+      __fwd.reset( __g.vertex_bound() );
+      __bwd.reset( __rg.vertex_bound() );
+      __fwd.set( __source, 0, __source );
+      __bwd.set( __target, 0, __target );
+      __fheap.push( { 0, __source } );
+      __bheap.push( { 0, __target } );
+
+      if( __source == __target )
+        { __best = 0; }
+
+      /** Шаг одной стороны: извлечение вершины и релаксация ее ребер
+       *  с проверкой встречи с другой стороной.
+       */
+      auto __step = [&]( const auto& __graph, _Heap& __heap,
+                         psearch_space& __self, const psearch_space& __other )
+        {
+        _Entry  __top = __heap.top();
+        __heap.pop();
+
+        __u32  __v = __top.second;
+        if( __top.first != __self.dist( __v ) )
+          { return; }
+
+        __result._S_settled++;
+
+        for( auto __c = __graph.adj_begin( __v );
+             __c != __graph.adj_end( __v );
+             __c = __graph.adj_next( __v, __c ) )
+          {
+          __u32  __w  = __graph.adj_target( __v, __c );
+          __u64  __nd = __top.first + __graph.adj_weight( __v, __c );
+
+          if( __nd < __self.dist( __w ) )
+            {
+            __self.set( __w, __nd, __v );
+            __heap.push( { __nd, __w } );
+            }
+
+          if( __other.dist( __w ) != unreachable_distance
+              && __self.dist( __w ) + __other.dist( __w ) < __best )
+            {
+            __best = __self.dist( __w ) + __other.dist( __w );
+            __meet = __w;
+            }
+          }
+        };
+
+      while( !__fheap.empty() && !__bheap.empty() )
+        {
+        if( __fheap.top().first + __bheap.top().first >= __best )
+          { break; }
+
+        if( __fheap.top().first <= __bheap.top().first )
+          { __step( __g, __fheap, __fwd, __bwd ); }
+        else
+          { __step( __rg, __bheap, __bwd, __fwd ); }
+        }
+
+      if( __best == unreachable_distance )
+        { return __result; }
+
+      __result._S_found = true;
+      __result._S_cost  = __best;
+
+      /** Путь: от начала до встречи по прямым предкам, далее до
+       *  цели по обратным.
+       */
+      __detail::unwind_path( __fwd, __source, __meet, __result._S_path );
+
+      for( __u32 __v = __meet; __v != __target; )
+        {
+        __v = __bwd.parent( __v );
+        __result._S_path.push_back( __v );
+        }
+
+      return __result;
+      }
+//--------------------------------------------------------------------
+// Двунаправленный поиск с временными рабочими массивами.
+  template <typename _Graph, typename _RGraph>
+    auto
+    bidirectional_dijkstra( const _Graph& __g, const _RGraph& __rg,
+                            __u32 __source, __u32 __target ) -> ppath_result
+      {
+      psearch_space  __fwd;
+      psearch_space  __bwd;
+      return bidirectional_dijkstra( __g, __rg, __source, __target,
+                                     __fwd, __bwd );
+      }
+//--------------------------------------------------------------------
+// Двунаправленный поиск на неориентированном графе.
+  template <typename _Graph>
+    auto
+    bidirectional_dijkstra( const _Graph& __g,
+                            __u32 __source, __u32 __target ) -> ppath_result
+      { return bidirectional_dijkstra( __g, __g, __source, __target ); }
+
+  } // namespace ptl
+
+#endif // __PTL_PSEARCH_H__
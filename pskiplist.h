@@ -0,0 +1,696 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для списка с пропусками.
+ */
+
+/**
+ *  (PTL) Patriarch library : pskiplist.h
+ */
+
+#pragma once
+#if !defined( __PTL_PSKIPLIST_H__ )
+#define __PTL_PSKIPLIST_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <utility>
+
+/*
+ * Список с пропусками (skip list) - упорядоченный словарь.
+ * Узел получает случайную высоту: уровень l + 1 есть у узла с
+ * вероятностью 1/4 при наличии уровня l. Поиск спускается с верхнего
+ * уровня, поэтому поиск, вставка и удаление стоят O(log n) в среднем.
+ *
+ * Классы:
+ *   - pskiplist - однопоточный список
+ *   - pconcurrent_skiplist - список без блокировок для нескольких
+ *     пишущих потоков (Herlihy, Shavit; Fraser)
+ *
+ * Методы:
+ *   - insert() - вставка пары, если ключа еще нет
+ *   - erase() - удаление по ключу
+ *   - find() - поиск значения по ключу
+ *   - contains() - проверка наличия ключа
+ *   - range() - обход пар с ключами из [lo, hi) по возрастанию
+ *   - size() - количество пар
+ *
+ * @code
+ *   ptl::pskiplist<ptl::__u32, std::string> map;
+ *   map.insert( 5, "five" );
+ *   map.range( 0, 10, []( ptl::__u32 k, const std::string& v ) { ... } );
+ * @endcode
+ */
+
+namespace ptl
+  {
+  namespace __detail
+    {
+    // Наибольшая высота узла списка с пропусками.
+    constexpr __u32  skiplist_max_level = 32;
+//--------------------------------------------------------------------
+// Случайная высота узла: по два случайных бита на уровень
+// (вероятность продолжения 1/4). __state - состояние xorshift64.
+    inline auto
+    skiplist_level( __u64& __state ) -> __u32
+      {
+      __state ^= __state << 13;
+      __state ^= __state >> 7;
+      __state ^= __state << 17;
+
+      __u64  __bits  = __state;
+      __u32  __level{ 1 };
+
+      while( __level < skiplist_max_level && ( __bits & 3 ) == 0 )
+        {
+        __level++;
+        __bits >>= 2;
+        }
+
+      return __level;
+      }
+    } // namespace __detail
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Однопоточный список с пропусками.
+   * Узел и массив его ссылок выделяются одним блоком памяти.
+   */
+  template <typename _Key, typename _Val, typename _Compare = std::less<_Key>>
+  class pskiplist
+    {
+    private:
+      struct _Node
+        {
+        _Key   _S_key;
+        _Val   _S_val;
+        __u32  _S_level;
+
+        _Node( const _Key& __key, const _Val& __val, __u32 __level )
+          : _S_key( __key ), _S_val( __val ), _S_level( __level )
+          { }
+
+        // Ссылки на следующие узлы по уровням - сразу за узлом.
+        auto
+        next() -> _Node**
+          { return reinterpret_cast<_Node**>( reinterpret_cast<char*>( this ) + __links ); }
+        };
+
+      // Смещение массива ссылок от начала узла: размер узла,
+      // округленный до выравнивания ссылки. Без округления для
+      // pskiplist<__u32, __u32> (sizeof( _Node ) == 12) ссылки
+      // лежали бы по невыровненным адресам.
+      static constexpr __u64  __links =
+        ( sizeof( _Node ) + alignof( _Node* ) - 1 ) / alignof( _Node* ) * alignof( _Node* );
+
+      _Node*    _M_head[__detail::skiplist_max_level]; // Ссылки начала
+      __u32     _M_level{ 1 };                         // Занятых уровней
+      __u64     _M_size{ 0 };
+      __u64     _M_rng{ 0x9E3779B97F4A7C15ULL };       // Состояние xorshift
+      _Compare  _M_less;
+
+      static auto
+      create( const _Key& __key, const _Val& __val, __u32 __level ) -> _Node*
+        {
+        void*   __p = ::operator new( __links + __level * sizeof( _Node* ) );
+        _Node*  __n;
+
+        try
+          { __n = new( __p ) _Node( __key, __val, __level ); }
+        catch( ... )
+          {
+          ::operator delete( __p );
+          throw;
+          }
+
+        for( __u32 __l{ 0 }; __l < __level; __l++ )
+          { __n->next()[__l] = nullptr; }
+        return __n;
+        }
+//--------------------------------------------------------------------
+      static auto
+      destroy( _Node* __n ) -> void
+        {
+        __n->~_Node();
+        ::operator delete( __n );
+        }
+//--------------------------------------------------------------------
+      // Спуск к первому узлу с ключом не меньше __key. В __update[l]
+      // записывается массив ссылок последнего узла уровня l с
+      // меньшим ключом (или начало списка).
+      auto
+      search( const _Key& __key, _Node** __update[] ) -> _Node*
+        {
+        _Node**  __next = _M_head;
+
+        for( __u32 __l = _M_level; __l-- > 0; )
+          {
+          while( __next[__l] != nullptr && _M_less( __next[__l]->_S_key, __key ) )
+            { __next = __next[__l]->next(); }
+          __update[__l] = __next;
+          }
+
+        return __next[0];
+        }
+//--------------------------------------------------------------------
+      // Первый узел с ключом не меньше __key.
+      auto
+      lower_bound( const _Key& __key ) const -> _Node*
+        {
+        _Node* const*  __next = _M_head;
+
+        for( __u32 __l = _M_level; __l-- > 0; )
+          {
+          while( __next[__l] != nullptr && _M_less( __next[__l]->_S_key, __key ) )
+            { __next = __next[__l]->next(); }
+          }
+
+        return __next[0];
+        }
+
+    public:
+      explicit
+      pskiplist( const _Compare& __less = _Compare() )
+        : _M_less( __less )
+        {
+        for( __u32 __l{ 0 }; __l < __detail::skiplist_max_level; __l++ )
+          { _M_head[__l] = nullptr; }
+        }
+
+      pskiplist( const pskiplist& ) = delete;
+
+      pskiplist&
+      operator=( const pskiplist& ) = delete;
+
+      ~pskiplist() noexcept
+        { clear(); }
+//--------------------------------------------------------------------
+// Вставка пары. false - ключ уже есть, значение не меняется.
+      auto
+      insert( const _Key& __key, const _Val& __val ) -> bool
+        {
+        _Node**  __update[__detail::skiplist_max_level];
+        _Node*   __n = search( __key, __update );
+
+        if( __n != nullptr && !_M_less( __key, __n->_S_key ) )
+          { return false; }
+
+        __u32  __level = __detail::skiplist_level( _M_rng );
+        for( ; _M_level < __level; _M_level++ )
+          { __update[_M_level] = _M_head; }
+
+        __n = create( __key, __val, __level );
+        for( __u32 __l{ 0 }; __l < __level; __l++ )
+          {
+          __n->next()[__l] = __update[__l][__l];
+          __update[__l][__l] = __n;
+          }
+
+        _M_size++;
+        return true;
+        }
+//--------------------------------------------------------------------
+// Удаление по ключу. false - ключа нет.
+      auto
+      erase( const _Key& __key ) -> bool
+        {
+        _Node**  __update[__detail::skiplist_max_level];
+        _Node*   __n = search( __key, __update );
+
+        if( __n == nullptr || _M_less( __key, __n->_S_key ) )
+          { return false; }
+
+        for( __u32 __l{ 0 }; __l < __n->_S_level; __l++ )
+          { __update[__l][__l] = __n->next()[__l]; }
+
+        destroy( __n );
+        _M_size--;
+
+        while( _M_level > 1 && _M_head[_M_level - 1] == nullptr )
+          { _M_level--; }
+        return true;
+        }
+//--------------------------------------------------------------------
+// Указатель на значение по ключу; nullptr - ключа нет.
+      auto
+      find( const _Key& __key ) -> _Val*
+        {
+        _Node*  __n = lower_bound( __key );
+
+        if( __n == nullptr || _M_less( __key, __n->_S_key ) )
+          { return nullptr; }
+        return &__n->_S_val;
+        }
+//--------------------------------------------------------------------
+      auto
+      contains( const _Key& __key ) const -> bool
+        {
+        _Node*  __n = lower_bound( __key );
+        return __n != nullptr && !_M_less( __key, __n->_S_key );
+        }
+//--------------------------------------------------------------------
+// Вызов __f( key, value ) для пар с ключами из [__lo, __hi) по
+// возрастанию ключа.
+      template <typename _Func>
+        auto
+        range( const _Key& __lo, const _Key& __hi, _Func __f ) const -> void
+          {
+          for( _Node* __n = lower_bound( __lo );
+               __n != nullptr && _M_less( __n->_S_key, __hi );
+               __n = __n->next()[0] )
+            { __f( static_cast<const _Key&>( __n->_S_key ),
+                   static_cast<const _Val&>( __n->_S_val ) ); }
+          }
+//--------------------------------------------------------------------
+      auto
+      size() const -> __u64
+        { return _M_size; }
+//--------------------------------------------------------------------
+      auto
+      empty() const -> bool
+        { return _M_size == 0; }
+//--------------------------------------------------------------------
+      auto
+      clear() -> void
+        {
+        _Node*  __n = _M_head[0];
+
+        while( __n != nullptr )
+          {
+          _Node*  __next = __n->next()[0];
+          destroy( __n );
+          __n = __next;
+          }
+
+        for( __u32 __l{ 0 }; __l < __detail::skiplist_max_level; __l++ )
+          { _M_head[__l] = nullptr; }
+        _M_level = 1;
+        _M_size  = 0;
+        }
+
+    }; // class pskiplist
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Список с пропусками без блокировок.
+   *
+   * Ссылка на следующий узел хранит в младшем бите метку удаления
+   * узла-владельца. Удаление сначала помечает ссылки узла сверху вниз;
+   * метка нижнего уровня - момент удаления. Помеченные узлы вырезаются
+   * из уровней при поиске любым потоком. Вставка связывает узел снизу
+   * вверх и прекращается, если узел уже помечен.
+   *
+   * Память удаленных узлов не освобождается, пока списком пользуются
+   * другие потоки: узлы копятся в списке удаленных и освобождаются в
+   * reclaim(), который вызывается в момент, когда других обращений к
+   * списку нет, либо в деструкторе.
+   *
+   * Значение узла не меняется после вставки; find() возвращает копию.
+   * range() и size() согласованы слабо: при одновременных изменениях
+   * они видят часть из них.
+   */
+  template <typename _Key, typename _Val, typename _Compare = std::less<_Key>>
+  class pconcurrent_skiplist
+    {
+    private:
+      typedef std::atomic<std::uintptr_t>  _Link;
+
+      struct _Node
+        {
+        const _Key  _S_key;
+        const _Val  _S_val;
+        __u32       _S_level;
+        _Node*      _S_retired{ nullptr }; // Следующий в списке удаленных
+
+        _Node( const _Key& __key, const _Val& __val, __u32 __level )
+          : _S_key( __key ), _S_val( __val ), _S_level( __level )
+          { }
+
+        auto
+        next() -> _Link*
+          { return reinterpret_cast<_Link*>( reinterpret_cast<char*>( this ) + __links ); }
+        };
+
+      // Смещение массива ссылок от начала узла, округленное до
+      // выравнивания ссылки, как в pskiplist.
+      static constexpr __u64  __links =
+        ( sizeof( _Node ) + alignof( _Link ) - 1 ) / alignof( _Link ) * alignof( _Link );
+
+      _Link                _M_head[__detail::skiplist_max_level];
+      std::atomic<_Node*>  _M_retired{ nullptr };
+      std::atomic<__u64>   _M_size{ 0 };
+      _Compare             _M_less;
+
+      static auto
+      ptr( std::uintptr_t __link ) -> _Node*
+        { return reinterpret_cast<_Node*>( __link & ~std::uintptr_t( 1 ) ); }
+
+      static auto
+      marked( std::uintptr_t __link ) -> bool
+        { return ( __link & 1 ) != 0; }
+
+      static auto
+      link( _Node* __n ) -> std::uintptr_t
+        { return reinterpret_cast<std::uintptr_t>( __n ); }
+//--------------------------------------------------------------------
+      static auto
+      create( const _Key& __key, const _Val& __val, __u32 __level ) -> _Node*
+        {
+        void*   __p = ::operator new( __links + __level * sizeof( _Link ) );
+        _Node*  __n;
+
+        try
+          { __n = new( __p ) _Node( __key, __val, __level ); }
+        catch( ... )
+          {
+          ::operator delete( __p );
+          throw;
+          }
+
+        for( __u32 __l{ 0 }; __l < __level; __l++ )
+          { new( __n->next() + __l ) _Link( 0 ); }
+        return __n;
+        }
+//--------------------------------------------------------------------
+      static auto
+      destroy( _Node* __n ) -> void
+        {
+        __n->~_Node();
+        ::operator delete( __n );
+        }
+//--------------------------------------------------------------------
+      // Случайная высота нового узла; состояние генератора свое у
+      // каждого потока.
+      static auto
+      random_level() -> __u32
+        {
+        thread_local __u64  __state =
+          0x9E3779B97F4A7C15ULL ^ reinterpret_cast<std::uintptr_t>( &__state );
+        return __detail::skiplist_level( __state );
+        }
+//--------------------------------------------------------------------
+      // Один проход поиска с вырезанием помеченных узлов. Заполняет
+      // __preds (массивы ссылок предшественников) и __succs по всем
+      // уровням. false - проход надо повторить: предшественник
+      // изменился под нами.
+      auto
+      find_pass( const _Key& __key, _Link* __preds[], _Node* __succs[] ) -> bool
+        {
+        _Link*  __pred = _M_head;
+
+        for( __u32 __l = __detail::skiplist_max_level; __l-- > 0; )
+          {
+          _Node*  __curr = ptr( __pred[__l].load( std::memory_order_acquire ) );
+
+          while( __curr != nullptr )
+            {
+            std::uintptr_t  __succ = __curr->next()[__l].load( std::memory_order_acquire );
+
+            if( marked( __succ ) )
+              {
+              std::uintptr_t  __expected = link( __curr );
+              if( !__pred[__l].compare_exchange_strong( __expected, __succ & ~std::uintptr_t( 1 ),
+                                                        std::memory_order_acq_rel,
+                                                        std::memory_order_acquire ) )
+                { return false; }
+              __curr = ptr( __succ );
+              continue;
+              }
+
+            if( !_M_less( __curr->_S_key, __key ) )
+              { break; }
+
+            __pred = __curr->next();
+            __curr = ptr( __succ );
+            }
+
+          __preds[__l] = __pred;
+          __succs[__l] = __curr;
+          }
+
+        return true;
+        }
+//--------------------------------------------------------------------
+      // Поиск с повторами. true - узел с ключом __key есть на нижнем
+      // уровне (это __succs[0]).
+      auto
+      find( const _Key& __key, _Link* __preds[], _Node* __succs[] ) -> bool
+        {
+        while( !find_pass( __key, __preds, __succs ) )
+          { }
+        return __succs[0] != nullptr && !_M_less( __key, __succs[0]->_S_key );
+        }
+//--------------------------------------------------------------------
+      // Первый непомеченный узел с ключом не меньше __key без
+      // изменения списка.
+      auto
+      lower_bound( const _Key& __key ) const -> _Node*
+        {
+        const _Link*  __pred = _M_head;
+        _Node*        __curr = nullptr;
+
+        for( __u32 __l = __detail::skiplist_max_level; __l-- > 0; )
+          {
+          __curr = ptr( __pred[__l].load( std::memory_order_acquire ) );
+
+          while( __curr != nullptr )
+            {
+            std::uintptr_t  __succ = __curr->next()[__l].load( std::memory_order_acquire );
+
+            if( !marked( __succ ) && !_M_less( __curr->_S_key, __key ) )
+              { break; }
+            if( !marked( __succ ) )
+              { __pred = __curr->next(); }
+            __curr = ptr( __succ );
+            }
+          }
+
+        return __curr;
+        }
+
+    public:
+      explicit
+      pconcurrent_skiplist( const _Compare& __less = _Compare() )
+        : _M_less( __less )
+        {
+        for( __u32 __l{ 0 }; __l < __detail::skiplist_max_level; __l++ )
+          { _M_head[__l].store( 0, std::memory_order_relaxed ); }
+        }
+
+      pconcurrent_skiplist( const pconcurrent_skiplist& ) = delete;
+
+      pconcurrent_skiplist&
+      operator=( const pconcurrent_skiplist& ) = delete;
+
+      ~pconcurrent_skiplist() noexcept
+        {
+        reclaim();
+
+        _Node*  __n = ptr( _M_head[0].load( std::memory_order_relaxed ) );
+        while( __n != nullptr )
+          {
+          _Node*  __next = ptr( __n->next()[0].load( std::memory_order_relaxed ) );
+          destroy( __n );
+          __n = __next;
+          }
+        }
+//--------------------------------------------------------------------
+// Вставка пары. false - ключ уже есть.
+      auto
+      insert( const _Key& __key, const _Val& __val ) -> bool
+        {
+        _Link*  __preds[__detail::skiplist_max_level];
+        _Node*  __succs[__detail::skiplist_max_level];
+        _Node*  __n{ nullptr };
+        __u32   __level = random_level();
+
+        /** Публикация на нижнем уровне - момент вставки.
+         */
+        for( ;; )
+          {
+          if( find( __key, __preds, __succs ) )
+            {
+            if( __n != nullptr )
+              { destroy( __n ); }
+            return false;
+            }
+
+          if( __n == nullptr )
+            { __n = create( __key, __val, __level ); }
+
+          for( __u32 __l{ 0 }; __l < __level; __l++ )
+            { __n->next()[__l].store( link( __succs[__l] ), std::memory_order_relaxed ); }
+
+          std::uintptr_t  __expected = link( __succs[0] );
+          if( __preds[0][0].compare_exchange_strong( __expected, link( __n ),
+                                                     std::memory_order_release,
+                                                     std::memory_order_relaxed ) )
+            { break; }
+          }
+
+        _M_size.fetch_add( 1, std::memory_order_relaxed );
+
+        /** Связывание верхних уровней. Если узел тем временем начали
+         *  удалять, связывание прекращается.
+         */
+        for( __u32 __l{ 1 }; __l < __level; __l++ )
+          {
+          for( ;; )
+            {
+            std::uintptr_t  __cur = __n->next()[__l].load( std::memory_order_acquire );
+            if( marked( __cur ) )
+              { return true; }
+
+            if( ptr( __cur ) != __succs[__l]
+                && !__n->next()[__l].compare_exchange_strong( __cur, link( __succs[__l] ),
+                                                              std::memory_order_release,
+                                                              std::memory_order_relaxed ) )
+              { continue; }
+
+            std::uintptr_t  __expected = link( __succs[__l] );
+            if( __preds[__l][__l].compare_exchange_strong( __expected, link( __n ),
+                                                           std::memory_order_release,
+                                                           std::memory_order_relaxed ) )
+              { break; }
+
+            find( __key, __preds, __succs );
+            if( __succs[0] != __n )
+              { return true; }
+            }
+          }
+
+        return true;
+        }
+//--------------------------------------------------------------------
+// Удаление по ключу. false - ключа нет (или его удалил другой поток).
+      auto
+      erase( const _Key& __key ) -> bool
+        {
+        _Link*  __preds[__detail::skiplist_max_level];
+        _Node*  __succs[__detail::skiplist_max_level];
+
+        if( !find( __key, __preds, __succs ) )
+          { return false; }
+
+        _Node*  __victim = __succs[0];
+
+        for( __u32 __l = __victim->_S_level; __l-- > 1; )
+          {
+          std::uintptr_t  __succ = __victim->next()[__l].load( std::memory_order_acquire );
+          while( !marked( __succ ) )
+            {
+            __victim->next()[__l].compare_exchange_weak( __succ, __succ | 1,
+                                                         std::memory_order_acq_rel,
+                                                         std::memory_order_acquire );
+            }
+          }
+
+        std::uintptr_t  __succ = __victim->next()[0].load( std::memory_order_acquire );
+        for( ;; )
+          {
+          if( marked( __succ ) )
+            { return false; }
+
+          if( __victim->next()[0].compare_exchange_weak( __succ, __succ | 1,
+                                                         std::memory_order_acq_rel,
+                                                         std::memory_order_acquire ) )
+            { break; }
+          }
+
+        /** Узел удален; поиск вырезает его из уровней. Освобождение
+         *  памяти - в reclaim().
+         */
+        find( __key, __preds, __succs );
+        _M_size.fetch_sub( 1, std::memory_order_relaxed );
+
+        __victim->_S_retired = _M_retired.load( std::memory_order_relaxed );
+        while( !_M_retired.compare_exchange_weak( __victim->_S_retired, __victim,
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed ) )
+          { }
+        return true;
+        }
+//--------------------------------------------------------------------
+// Копия значения по ключу в __out. false - ключа нет.
+      auto
+      find( const _Key& __key, _Val& __out ) const -> bool
+        {
+        _Node*  __n = lower_bound( __key );
+
+        if( __n == nullptr || _M_less( __key, __n->_S_key ) )
+          { return false; }
+        __out = __n->_S_val;
+        return true;
+        }
+//--------------------------------------------------------------------
+      auto
+      contains( const _Key& __key ) const -> bool
+        {
+        _Node*  __n = lower_bound( __key );
+        return __n != nullptr && !_M_less( __key, __n->_S_key );
+        }
+//--------------------------------------------------------------------
+// Вызов __f( key, value ) для неудаленных пар с ключами из
+// [__lo, __hi) по возрастанию ключа.
+      template <typename _Func>
+        auto
+        range( const _Key& __lo, const _Key& __hi, _Func __f ) const -> void
+          {
+          for( _Node* __n = lower_bound( __lo );
+               __n != nullptr && _M_less( __n->_S_key, __hi ); )
+            {
+            std::uintptr_t  __succ = __n->next()[0].load( std::memory_order_acquire );
+            if( !marked( __succ ) )
+              { __f( __n->_S_key, __n->_S_val ); }
+            __n = ptr( __succ );
+            }
+          }
+//--------------------------------------------------------------------
+      auto
+      size() const -> __u64
+        { return _M_size.load( std::memory_order_relaxed ); }
+//--------------------------------------------------------------------
+// Освобождение памяти удаленных узлов. Вызывается, только когда
+// других обращений к списку нет: сначала из уровней вырезаются
+// помеченные узлы, которые могла вернуть незавершенная вставка,
+// затем удаленные узлы освобождаются.
+      auto
+      reclaim() -> void
+        {
+        for( __u32 __l{ 0 }; __l < __detail::skiplist_max_level; __l++ )
+          {
+          _Link*  __pred = _M_head;
+
+          for( _Node* __n = ptr( __pred[__l].load( std::memory_order_relaxed ) );
+               __n != nullptr; )
+            {
+            std::uintptr_t  __succ = __n->next()[__l].load( std::memory_order_relaxed );
+
+            if( marked( __succ ) )
+              { __pred[__l].store( __succ & ~std::uintptr_t( 1 ), std::memory_order_relaxed ); }
+            else
+              { __pred = __n->next(); }
+            __n = ptr( __succ );
+            }
+          }
+
+        _Node*  __n = _M_retired.exchange( nullptr, std::memory_order_acquire );
+        while( __n != nullptr )
+          {
+          _Node*  __next = __n->_S_retired;
+          destroy( __n );
+          __n = __next;
+          }
+        }
+
+    }; // class pconcurrent_skiplist
+
+  } // namespace ptl
+
+#endif // __PTL_PSKIPLIST_H__
@@ -0,0 +1,370 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для кольцевой очереди с одним производителем
+ * и одним потребителем.
+ */
+
+/**
+ *  (PTL) Patriarch library : pspsc_queue.h
+ */
+
+#pragma once
+#if !defined( __PTL_PSPSC_QUEUE_H__ )
+#define __PTL_PSPSC_QUEUE_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#if !defined( __PTL_PEXCEPT_H__ )
+#include "pexcept.h"
+#endif
+
+#if !defined( __PTL_PPARALLEL_H__ )
+#include "pparallel.h"
+#endif
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <utility>
+
+/*
+ * Кольцевая очередь для ровно одного потока-производителя и одного
+ * потока-потребителя. Операции без ожидания: производитель пишет
+ * только позицию записи, потребитель - только позицию чтения,
+ * синхронизация - парой release/acquire.
+ *
+ * Каждая сторона держит копию позиции другой стороны и перечитывает
+ * общую позицию, только когда по копии места (или данных) не хватает.
+ * Поэтому строка кэша чужой позиции переходит между ядрами один раз
+ * на много операций, а не на каждую.
+ *
+ * push_wait() и pop_wait() ждут места или данных: сначала активно,
+ * затем засыпают на futex. Сразу будят друг друга только эти два
+ * метода; после try_push(), push_n() и других неожидающих методов
+ * спящая сторона заметит изменение при очередной проверке - не
+ * позже чем через __sleep_ns наносекунд.
+ *
+ * Методы (производитель):
+ *   - try_push() - вставка элемента; false - очередь заполнена
+ *   - push_n() - вставка до n элементов копированием подряд
+ *   - push_wait() - вставка с ожиданием места
+ *
+ * Методы (потребитель):
+ *   - try_pop() - извлечение элемента; false - очередь пуста
+ *   - pop_n() - извлечение до n элементов перемещением подряд
+ *   - pop_wait() - извлечение с ожиданием данных
+ *
+ * Методы (любой поток):
+ *   - capacity() - емкость очереди
+ *   - size_approx() - приблизительное количество элементов
+ *
+ * Элементы хранятся в массиве _Tp, поэтому тип должен иметь
+ * конструктор по умолчанию.
+ *
+ * @code
+ *   ptl::pspsc_queue<ptl::__u64> queue( 4096 );
+ *   // производитель                // потребитель
+ *   queue.push_wait( x );            queue.pop_wait( y );
+ * @endcode
+ */
+
+namespace ptl
+  {
+  namespace __detail
+    {
+    static_assert( sizeof( std::atomic<__u32> ) == sizeof( __u32 ),
+                   "futex требует 32-битного атомарного слова." );
+//--------------------------------------------------------------------
+// Сон, пока слово __word равно __expected, но не дольше
+// __timeout_ns наносекунд (или до пробуждения).
+    inline auto
+    futex_wait( std::atomic<__u32>& __word, __u32 __expected,
+                long __timeout_ns ) -> void
+      {
+      struct timespec  __ts = { __timeout_ns / 1000000000L,
+                                __timeout_ns % 1000000000L };
+
+      ::syscall( SYS_futex, reinterpret_cast<__u32*>( &__word ),
+                 FUTEX_WAIT_PRIVATE, __expected, &__ts, nullptr, 0 );
+      }
+//--------------------------------------------------------------------
+// Пробуждение одного потока, спящего на слове __word.
+    inline auto
+    futex_wake( std::atomic<__u32>& __word ) -> void
+      {
+      ::syscall( SYS_futex, reinterpret_cast<__u32*>( &__word ),
+                 FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0 );
+      }
+    } // namespace __detail
+//////////////////////////////////////////////////////////////////////
+  template <typename _Tp>
+  class pspsc_queue
+    {
+    private:
+      // Сколько раз проверить очередь активно и с уступкой
+      // процессора перед сном на futex.
+      static constexpr __u32  __spin_count  = 4096;
+      static constexpr __u32  __yield_count = 16;
+      // Наибольшая длительность одного сна на futex.
+      static constexpr long   __sleep_ns = 1000000;
+
+      /*
+       * Сторона ожидания: признак того, что поток спит или
+       * собирается уснуть, и счетчик событий, на котором он спит.
+       */
+      struct _Waiter
+        {
+        std::atomic<__u32>  _S_waiting{ 0 };
+        std::atomic<__u32>  _S_event{ 0 };
+        };
+
+      std::unique_ptr<_Tp[]>  _M_buffer;
+      __u64                   _M_mask;
+
+      // Строка производителя.
+      alignas( cache_line_size ) std::atomic<__u64>  _M_tail{ 0 };
+      __u64                                          _M_head_cache{ 0 };
+
+      // Строка потребителя.
+      alignas( cache_line_size ) std::atomic<__u64>  _M_head{ 0 };
+      __u64                                          _M_tail_cache{ 0 };
+
+      alignas( cache_line_size ) _Waiter  _M_consumer; // Ждет данных
+      alignas( cache_line_size ) _Waiter  _M_producer; // Ждет места
+
+//--------------------------------------------------------------------
+      // Ожидание условия __ready(): активно, затем на futex стороны
+      // __self. Перед сном признак ожидания публикуется и условие
+      // перепроверяется, поэтому пробуждение не теряется.
+      template <typename _Ready>
+        static auto
+        wait( _Waiter& __self, _Ready __ready ) -> void
+          {
+          /** На одном ядре активное ожидание бесполезно: другая
+           *  сторона не работает, пока ждущий поток занимает ядро.
+           */
+          static const __u32  __spins = hardware_threads() > 1 ? __spin_count : 0;
+
+          for( __u32 __i{ 0 }; __i < __spins; __i++ )
+            {
+            if( __ready() )
+              { return; }
+            cpu_relax();
+            }
+
+          for( __u32 __i{ 0 }; __i < __yield_count; __i++ )
+            {
+            if( __ready() )
+              { return; }
+            std::this_thread::yield();
+            }
+
+          for( ;; )
+            {
+            __u32  __event = __self._S_event.load( std::memory_order_acquire );
+
+            __self._S_waiting.store( 1, std::memory_order_relaxed );
+            std::atomic_thread_fence( std::memory_order_seq_cst );
+
+            if( __ready() )
+              { break; }
+
+            __detail::futex_wait( __self._S_event, __event, __sleep_ns );
+            }
+
+          __self._S_waiting.store( 0, std::memory_order_relaxed );
+          }
+//--------------------------------------------------------------------
+      // Пробуждение стороны __other, если она ждет.
+      static auto
+      notify( _Waiter& __other ) -> void
+        {
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+
+        if( __other._S_waiting.load( std::memory_order_relaxed ) )
+          {
+          __other._S_event.fetch_add( 1, std::memory_order_release );
+          __detail::futex_wake( __other._S_event );
+          }
+        }
+
+    public:
+      /** Емкость округляется вверх до степени двойки (не меньше 2).
+       */
+      explicit
+      pspsc_queue( __u64 __capacity )
+        {
+        if( __capacity == 0 || __capacity > ( 1ULL << 62 ) )
+          { throw pexception( "E: Недопустимая емкость очереди." ); }
+
+        __u64  __size{ 2 };
+        while( __size < __capacity )
+          { __size <<= 1; }
+
+        _M_buffer.reset( new _Tp[__size] );
+        _M_mask = __size - 1;
+        }
+
+      pspsc_queue( const pspsc_queue& ) = delete;
+
+      pspsc_queue&
+      operator=( const pspsc_queue& ) = delete;
+
+      ~pspsc_queue() noexcept
+        { }
+//--------------------------------------------------------------------
+      template <typename _Up>
+        auto
+        try_push( _Up&& __data ) -> bool
+          {
+          __u64  __tail = _M_tail.load( std::memory_order_relaxed );
+
+          if( __tail - _M_head_cache > _M_mask )
+            {
+            _M_head_cache = _M_head.load( std::memory_order_acquire );
+            if( __tail - _M_head_cache > _M_mask )
+              { return false; }
+            }
+
+          _M_buffer[__tail & _M_mask] = std::forward<_Up>( __data );
+          _M_tail.store( __tail + 1, std::memory_order_release );
+          return true;
+          }
+//--------------------------------------------------------------------
+      auto
+      try_pop( _Tp& __out ) -> bool
+        {
+        __u64  __head = _M_head.load( std::memory_order_relaxed );
+
+        if( __head == _M_tail_cache )
+          {
+          _M_tail_cache = _M_tail.load( std::memory_order_acquire );
+          if( __head == _M_tail_cache )
+            { return false; }
+          }
+
+        __out = std::move( _M_buffer[__head & _M_mask] );
+        _M_head.store( __head + 1, std::memory_order_release );
+        return true;
+        }
+//--------------------------------------------------------------------
+// Вставка до __n элементов массива __data не более чем двумя
+// непрерывными копированиями (до конца кольца и с его начала).
+// Возвращает количество вставленных.
+      auto
+      push_n( const _Tp* __data, __u64 __n ) -> __u64
+        {
+        __u64  __tail = _M_tail.load( std::memory_order_relaxed );
+        __u64  __free = _M_mask + 1 - ( __tail - _M_head_cache );
+
+        if( __free < __n )
+          {
+          _M_head_cache = _M_head.load( std::memory_order_acquire );
+          __free = _M_mask + 1 - ( __tail - _M_head_cache );
+          }
+
+        __u64  __k     = __n < __free ? __n : __free;
+        __u64  __at    = __tail & _M_mask;
+        __u64  __first = std::min( __k, _M_mask + 1 - __at );
+
+        std::copy( __data, __data + __first, _M_buffer.get() + __at );
+        std::copy( __data + __first, __data + __k, _M_buffer.get() );
+
+        _M_tail.store( __tail + __k, std::memory_order_release );
+        return __k;
+        }
+//--------------------------------------------------------------------
+// Извлечение до __n элементов в массив __out не более чем двумя
+// непрерывными перемещениями. Возвращает количество извлеченных.
+      auto
+      pop_n( _Tp* __out, __u64 __n ) -> __u64
+        {
+        __u64  __head  = _M_head.load( std::memory_order_relaxed );
+        __u64  __avail = _M_tail_cache - __head;
+
+        if( __avail < __n )
+          {
+          _M_tail_cache = _M_tail.load( std::memory_order_acquire );
+          __avail = _M_tail_cache - __head;
+          }
+
+        __u64  __k     = __n < __avail ? __n : __avail;
+        __u64  __at    = __head & _M_mask;
+        __u64  __first = std::min( __k, _M_mask + 1 - __at );
+
+        std::move( _M_buffer.get() + __at, _M_buffer.get() + __at + __first, __out );
+        std::move( _M_buffer.get(), _M_buffer.get() + ( __k - __first ), __out + __first );
+
+        _M_head.store( __head + __k, std::memory_order_release );
+        return __k;
+        }
+//--------------------------------------------------------------------
+// Вставка с ожиданием места.
+      template <typename _Up>
+        auto
+        push_wait( _Up&& __data ) -> void
+          {
+          auto __space = [&]()
+            {
+            __u64  __tail = _M_tail.load( std::memory_order_relaxed );
+            if( __tail - _M_head_cache <= _M_mask )
+              { return true; }
+            _M_head_cache = _M_head.load( std::memory_order_acquire );
+            return __tail - _M_head_cache <= _M_mask;
+            };
+
+          if( !__space() )
+            { wait( _M_producer, __space ); }
+
+          try_push( std::forward<_Up>( __data ) );
+          notify( _M_consumer );
+          }
+//--------------------------------------------------------------------
+// Извлечение с ожиданием данных.
+      auto
+      pop_wait( _Tp& __out ) -> void
+        {
+        auto __data = [&]()
+          {
+          __u64  __head = _M_head.load( std::memory_order_relaxed );
+          if( __head != _M_tail_cache )
+            { return true; }
+          _M_tail_cache = _M_tail.load( std::memory_order_acquire );
+          return __head != _M_tail_cache;
+          };
+
+        if( !__data() )
+          { wait( _M_consumer, __data ); }
+
+        try_pop( __out );
+        notify( _M_producer );
+        }
+//--------------------------------------------------------------------
+      auto
+      capacity() const -> __u64
+        { return _M_mask + 1; }
+//--------------------------------------------------------------------
+      auto
+      size_approx() const -> __u64
+        {
+        __u64  __head = _M_head.load( std::memory_order_relaxed );
+        __u64  __tail = _M_tail.load( std::memory_order_relaxed );
+        return __tail > __head ? __tail - __head : 0;
+        }
+
+    }; // class pspsc_queue
+
+  } // namespace ptl
+
+#endif // __PTL_PSPSC_QUEUE_H__
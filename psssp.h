@@ -0,0 +1,286 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для поиска кратчайших путей из одной вершины.
+ */
+
+/**
+ *  (PTL) Patriarch library : psssp.h
+ */
+
+#pragma once
+#if !defined( __PTL_PSSSP_H__ )
+#define __PTL_PSSSP_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#if !defined( __PTL_PEXCEPT_H__ )
+#include "pexcept.h"
+#endif
+
+#if !defined( __PTL_PPARALLEL_H__ )
+#include "pparallel.h"
+#endif
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <utility>
+#include <vector>
+
+/*
+ * Кратчайшие расстояния от одной вершины до всех остальных во
+ * взвешенном графе с неотрицательными весами. Граф должен
+ * предоставлять курсоры смежности с adj_weight().
+ *
+ * Функции:
+ *   - dijkstra() - последовательный алгоритм Дейкстры на куче
+ *   - delta_stepping() - параллельный алгоритм delta-stepping
+ *
+ * Результат - вектор расстояний; для недостижимых вершин
+ * unreachable_distance.
+ *
+ * @code
+ *   ptl::ptask_pool pool( 8 );
+ *   std::vector<ptl::__u64> dist = ptl::delta_stepping( graph, 0, 100, pool );
+ * @endcode
+ */
+
+namespace ptl
+  {
+  // Расстояние до недостижимой вершины.
+  constexpr __u64  unreachable_distance = 0xFFFFFFFFFFFFFFFFULL;
+//--------------------------------------------------------------------
+// Алгоритм Дейкстры на двоичной куче с ленивым удалением:
+// устаревшие записи кучи пропускаются при извлечении.
+  template <typename _Graph>
+    auto
+    dijkstra( const _Graph& __g, __u32 __source ) -> std::vector<__u64>
+      {
+      typedef std::pair<__u64, __u32>  _Entry; // расстояние, вершина
+
+      std::vector<__u64>  __dist( __g.vertex_bound(), unreachable_distance );
+      std::priority_queue<_Entry, std::vector<_Entry>,
+                          std::greater<_Entry>>  __heap;
+
+      __dist[__source] = 0;
+      __heap.push( { 0, __source } );
+
+      while( !__heap.empty() )
+        {
+        _Entry  __top = __heap.top();
+        __heap.pop();
+
+        __u32  __v = __top.second;
+        if( __top.first != __dist[__v] )
+          { continue; }
+
+        for( auto __c = __g.adj_begin( __v );
+             __c != __g.adj_end( __v );
+             __c = __g.adj_next( __v, __c ) )
+          {
+          __u32  __w  = __g.adj_target( __v, __c );
+          __u64  __nd = __top.first + __g.adj_weight( __v, __c );
+
+          if( __nd < __dist[__w] )
+            {
+            __dist[__w] = __nd;
+            __heap.push( { __nd, __w } );
+            }
+          }
+        }
+
+      return __dist;
+      }
+
+  namespace __detail
+    {
+//--------------------------------------------------------------------
+// Атомарное уменьшение расстояния. true - если значение уменьшено.
+    inline auto
+    atomic_relax( std::atomic<__u64>& __d, __u64 __value ) -> bool
+      {
+      __u64  __cur = __d.load( std::memory_order_relaxed );
+
+      while( __value < __cur )
+        {
+        if( __d.compare_exchange_weak( __cur, __value,
+                                       std::memory_order_relaxed ) )
+          { return true; }
+        }
+
+      return false;
+      }
+    } // namespace __detail
+//--------------------------------------------------------------------
+// Параллельный алгоритм delta-stepping (Meyer, Sanders).
+// Вершины раскладываются по корзинам ширины __delta по текущему
+// расстоянию. Корзины обрабатываются по возрастанию: легкие ребра
+// (вес <= __delta) релаксируются повторно, пока корзина не опустеет,
+// так как могут вернуть вершину в ту же корзину; тяжелые ребра
+// релаксируются один раз для всех вершин, покинувших корзину.
+// Релаксации фазы выполняются параллельно на пуле потоков.
+  template <typename _Graph>
+    auto
+    delta_stepping( const _Graph& __g, __u32 __source, __u64 __delta,
+                    ptask_pool& __pool ) -> std::vector<__u64>
+      {
+      if( __delta == 0 )
+        { throw pexception( "E: Ширина корзины delta должна быть больше 0." ); }
+
+      __u32  __n{ __g.vertex_bound() };
+      __u32  __threads{ __pool.size() };
+
+      std::unique_ptr<std::atomic<__u64>[]>  __dist( new std::atomic<__u64>[__n] );
+
+      /** Наибольший вес ребра ограничивает разброс активных корзин,
+       *  поэтому корзины хранятся кольцом из __span элементов.
+       */
+      std::vector<__u64>  __max_w( __threads, 0 );
+
+      __pool.parallel_for( 0, __n, [&]( __u64 __i, __u32 __t )
+        {
+        __u32  __v = static_cast<__u32>( __i );
+
+        __dist[__v].store( unreachable_distance, std::memory_order_relaxed );
+
+        for( auto __c = __g.adj_begin( __v );
+             __c != __g.adj_end( __v );
+             __c = __g.adj_next( __v, __c ) )
+          {
+          __u64  __w = __g.adj_weight( __v, __c );
+          if( __w > __max_w[__t] )
+            { __max_w[__t] = __w; }
+          }
+        } );
+
+      __u64  __max_weight{ 0 };
+      for( __u64 __w : __max_w )
+        { __max_weight = __w > __max_weight ? __w : __max_weight; }
+
+      __u64  __span = __max_weight / __delta + 2;
+
+      std::vector<std::vector<__u32>>  __buckets( __span );
+      std::vector<std::vector<__u32>>  __local( __threads ); // улучшенные вершины
+      std::vector<__u64>               __frontier_mark( __n, ~0ULL );
+      std::vector<__u64>               __settled_mark( __n, ~0ULL );
+
+      __dist[__source].store( 0, std::memory_order_relaxed );
+      __buckets[0].push_back( __source );
+
+      /** Перенос улучшенных вершин из буферов потоков в корзины.
+       */
+      auto __flush = [&]()
+        {
+        for( std::vector<__u32>& __l : __local )
+          {
+          for( __u32 __v : __l )
+            {
+            __u64  __b = __dist[__v].load( std::memory_order_relaxed ) / __delta;
+            __buckets[__b % __span].push_back( __v );
+            }
+          __l.clear();
+          }
+        };
+
+      /** Релаксация легких (__light) или тяжелых ребер вершины.
+       */
+      auto __relax = [&]( __u32 __v, __u32 __t, bool __light )
+        {
+        __u64  __dv = __dist[__v].load( std::memory_order_relaxed );
+
+        for( auto __c = __g.adj_begin( __v );
+             __c != __g.adj_end( __v );
+             __c = __g.adj_next( __v, __c ) )
+          {
+          __u64  __w = __g.adj_weight( __v, __c );
+          if( ( __w <= __delta ) != __light )
+            { continue; }
+
+          __u32  __u = __g.adj_target( __v, __c );
+          if( __detail::atomic_relax( __dist[__u], __dv + __w ) )
+            { __local[__t].push_back( __u ); }
+          }
+        };
+
+      std::vector<__u32>  __frontier;
+      std::vector<__u32>  __settled;
+      __u64               __round{ 0 };
+
+      for( __u64 __cur{ 0 }; ; __cur++ )
+        {
+        /** Поиск ближайшей непустой корзины в пределах кольца.
+         */
+        __u64  __skip{ 0 };
+        while( __skip < __span && __buckets[__cur % __span].empty() )
+          {
+          __cur++;
+          __skip++;
+          }
+        if( __skip == __span )
+          { break; }
+
+        std::vector<__u32>&  __bucket = __buckets[__cur % __span];
+        __settled.clear();
+
+        while( !__bucket.empty() )
+          {
+          /** Фронт - вершины корзины без дублей и устаревших записей
+           *  (вершин, ушедших в корзину с меньшим номером не бывает,
+           *  но вершина могла попасть в корзину дважды).
+           */
+          __frontier.clear();
+          for( __u32 __v : __bucket )
+            {
+            if( __frontier_mark[__v] != __round
+                && __dist[__v].load( std::memory_order_relaxed ) / __delta
+                   == __cur )
+              {
+              __frontier_mark[__v] = __round;
+              __frontier.push_back( __v );
+
+              if( __settled_mark[__v] != __cur )
+                {
+                __settled_mark[__v] = __cur;
+                __settled.push_back( __v );
+                }
+              }
+            }
+          __bucket.clear();
+          __round++;
+
+          __pool.parallel_for( 0, __frontier.size(), [&]( __u64 __i, __u32 __t )
+            { __relax( __frontier[__i], __t, true ); }, 64 );
+          __flush();
+          }
+
+        __pool.parallel_for( 0, __settled.size(), [&]( __u64 __i, __u32 __t )
+          { __relax( __settled[__i], __t, false ); }, 64 );
+        __flush();
+        }
+
+      std::vector<__u64>  __result( __n );
+      for( __u32 __v{ 0 }; __v < __n; __v++ )
+        { __result[__v] = __dist[__v].load( std::memory_order_relaxed ); }
+
+      return __result;
+      }
+//--------------------------------------------------------------------
+// Delta-stepping на временном пуле из __threads потоков.
+  template <typename _Graph>
+    auto
+    delta_stepping( const _Graph& __g, __u32 __source, __u64 __delta,
+                    __u32 __threads = hardware_threads() ) -> std::vector<__u64>
+      {
+      ptask_pool  __pool( __threads );
+      return delta_stepping( __g, __source, __delta, __pool );
+      }
+
+  } // namespace ptl
+
+#endif // __PTL_PSSSP_H__
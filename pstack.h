@@ -26,6 +26,9 @@
 #include "pexcept.h"
 #endif
 
+#include <utility>
+#include <vector>
+
 /*
  * Стек.
  * Реализован посредствам связанного списка.
@@ -36,6 +39,24 @@
  *   - push() - добавляет элемент на вершину стека
  *   - pop() - удаляет элемент с вершины стека и возращает его значение
  *   - peek() - выводит значение элемента с вершины стека
+ *
+ * Стек на непрерывном массиве (parray_stack).
+ * Элементы лежат подряд, память растет удвоением, поэтому push() и
+ * pop() не выделяют память на каждый элемент. Адреса элементов
+ * меняются при росте массива; если нужна их неизменность, следует
+ * использовать pstack.
+ *
+ * Методы:
+ *   - is_empty() - проверяет стек на пустоту (true - пуст, false - нет)
+ *   - push() - добавляет элемент на вершину стека
+ *   - emplace() - создает элемент на вершине стека из аргументов
+ *   - pop() - удаляет элемент с вершины стека и возвращает его,
+ *             перемещая, а не копируя
+ *   - top() - ссылка на элемент на вершине стека
+ *   - peek() - значение элемента с вершины стека
+ *   - reserve() - резервирует память под заданное количество элементов
+ *   - size() - количество элементов
+ *   - clear() - удаляет все элементы
  */
 
 namespace ptl
@@ -107,6 +128,84 @@ namespace ptl
         return _M_top->_M_data;
         }
     };
+//////////////////////////////////////////////////////////////////////
+  template <typename _Tp>
+  class parray_stack
+    {
+    private:
+      std::vector<_Tp>  _M_items; // Элементы, вершина - последний.
+
+    public:
+      parray_stack() = default;
+
+      ~parray_stack() noexcept
+        { }
+//--------------------------------------------------------------------
+      auto
+      is_empty() const -> bool
+        { return _M_items.empty(); }
+//--------------------------------------------------------------------
+      auto
+      push( const _Tp& __data ) -> void
+        { _M_items.push_back( __data ); }
+//--------------------------------------------------------------------
+      auto
+      push( _Tp&& __data ) -> void
+        { _M_items.push_back( std::move( __data ) ); }
+//--------------------------------------------------------------------
+      template <typename... _Args>
+        auto
+        emplace( _Args&&... __args ) -> _Tp&
+          { return _M_items.emplace_back( std::forward<_Args>( __args )... ); }
+//--------------------------------------------------------------------
+      auto
+      pop() -> _Tp
+        {
+        if( is_empty() )
+          throw 
+          pexception("W: Стек пуст.");
+
+        _Tp  __result = std::move( _M_items.back() );
+        _M_items.pop_back();
+        return __result;
+        }
+//--------------------------------------------------------------------
+      auto
+      top() -> _Tp&
+        {
+        if( is_empty() )
+          throw 
+          pexception("W: Стек пуст.");
+
+        return _M_items.back();
+        }
+//--------------------------------------------------------------------
+      auto
+      top() const -> const _Tp&
+        {
+        if( is_empty() )
+          throw 
+          pexception("W: Стек пуст.");
+
+        return _M_items.back();
+        }
+//--------------------------------------------------------------------
+      auto
+      peek() const -> _Tp
+        { return top(); }
+//--------------------------------------------------------------------
+      auto
+      reserve( __u64 __count ) -> void
+        { _M_items.reserve( __count ); }
+//--------------------------------------------------------------------
+      auto
+      size() const -> __u64
+        { return _M_items.size(); }
+//--------------------------------------------------------------------
+      auto
+      clear() -> void
+        { _M_items.clear(); }
+    };
 
   } // namespace ptl
 
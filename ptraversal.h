@@ -0,0 +1,354 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для обхода графов.
+ */
+
+/**
+ *  (PTL) Patriarch library : ptraversal.h
+ */
+
+#pragma once
+#if !defined( __PTL_PTRAVERSAL_H__ )
+#define __PTL_PTRAVERSAL_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#if !defined( __PTL_PEXCEPT_H__ )
+#include "pexcept.h"
+#endif
+
+#include <algorithm>
+#include <vector>
+
+/*
+ * Обход графа в глубину без рекурсии и обход в ширину.
+ *
+ * Алгоритмы работают с любым графом, предоставляющим курсоры
+ * смежности:
+ *   - vertex_bound() - верхняя граница номеров вершин (0..bound-1)
+ *   - adj_begin( v ) - курсор первого ребра вершины v
+ *   - adj_end( v ) - курсор за последним ребром вершины v
+ *   - adj_next( v, c ) - курсор ребра, следующего за c
+ *   - adj_target( v, c ) - вершина, в которую ведет ребро c
+ *
+ * Функции:
+ *   - bfs_levels() - обход в ширину, расстояния в ребрах
+ *   - dfs() - обход в глубину от заданной вершины с посетителем
+ *   - dfs_all() - обход в глубину всего графа с посетителем
+ *   - dfs_preorder() - вершины в порядке открытия
+ *   - dfs_postorder() - вершины в порядке закрытия
+ *   - topological_sort() - топологическая сортировка ориентированного
+ *                          графа (цикл - исключение)
+ *   - kahn_sort() - топологическая сортировка алгоритмом Кана
+ *                   (цикл - исключение)
+ *   - is_acyclic() - проверка ориентированного графа на отсутствие циклов
+ *
+ * Посетитель - любой тип с методами pdfs_visitor. Вызовы разрешаются
+ * на этапе компиляции и встраиваются, поэтому достаточно
+ * унаследоваться от pdfs_visitor и перекрыть нужные события.
+ *
+ * @code
+ *   struct counter : ptl::pdfs_visitor
+ *     {
+ *     ptl::__u32  _M_count{ 0 };
+ *     void discover_vertex( ptl::__u32 ) { ++_M_count; }
+ *     };
+ *
+ *   counter vis;
+ *   ptl::dfs( graph, 0, vis );
+ * @endcode
+ */
+
+namespace ptl
+  {
+//////////////////////////////////////////////////////////////////////
+  /*
+   * Посетитель обхода в глубину, игнорирующий все события.
+   */
+  struct pdfs_visitor
+    {
+    // Вершина впервые достигнута.
+    void discover_vertex( __u32 ) { }
+    // Все ребра вершины просмотрены.
+    void finish_vertex( __u32 ) { }
+    // Ребро дерева обхода (ведет в непосещенную вершину).
+    void tree_edge( __u32, __u32 ) { }
+    // Обратное ребро (ведет в вершину на текущем пути).
+    void back_edge( __u32, __u32 ) { }
+    // Прямое или перекрестное ребро (ведет в закрытую вершину).
+    void forward_or_cross_edge( __u32, __u32 ) { }
+    };
+
+  namespace __detail
+    {
+    enum : __u8
+      {
+      __white = 0, // вершина не посещалась
+      __gray  = 1, // вершина на стеке обхода
+      __black = 2  // вершина закрыта
+      };
+//--------------------------------------------------------------------
+// Обход в глубину от вершины __start с явным стеком.
+// Состояние вершин хранится в __color, поэтому несколько вызовов
+// могут разделять одну и ту же разметку.
+    template <typename _Graph, typename _Visitor>
+      auto
+      dfs_from( const _Graph& __g, __u32 __start, _Visitor& __vis,
+                std::vector<__u8>& __color ) -> void
+        {
+        typedef decltype( __g.adj_begin( __start ) )  _Cursor;
+
+        struct _Frame
+          {
+          __u32    _S_vertex; // вершина на стеке
+          _Cursor  _S_cursor; // следующее непросмотренное ребро
+          };
+
+        std::vector<_Frame>  __stack;
+
+        __color[__start] = __gray;
+        __vis.discover_vertex( __start );
+        __stack.push_back( { __start, __g.adj_begin( __start ) } );
+
+        while( !__stack.empty() )
+          {
+          _Frame&  __top = __stack.back();
+          __u32    __v   = __top._S_vertex;
+
+          if( __top._S_cursor == __g.adj_end( __v ) )
+            {
+            /** Ребра вершины исчерпаны - закрываем ее.
+             */
+            __color[__v] = __black;
+            __vis.finish_vertex( __v );
+            __stack.pop_back();
+            continue;
+            }
+
+          __u32  __w = __g.adj_target( __v, __top._S_cursor );
+          __top._S_cursor = __g.adj_next( __v, __top._S_cursor );
+
+          if( __color[__w] == __white )
+            {
+            /** Ссылка __top после push_back() недействительна,
+             *  поэтому все нужное взято из нее заранее.
+             */
+            __vis.tree_edge( __v, __w );
+            __color[__w] = __gray;
+            __vis.discover_vertex( __w );
+            __stack.push_back( { __w, __g.adj_begin( __w ) } );
+            }
+          else if( __color[__w] == __gray )
+            { __vis.back_edge( __v, __w ); }
+          else
+            { __vis.forward_or_cross_edge( __v, __w ); }
+          }
+        }
+//--------------------------------------------------------------------
+// Посетитель, собирающий вершины в порядке открытия.
+    struct preorder_visitor : pdfs_visitor
+      {
+      std::vector<__u32>&  _M_out;
+
+      void discover_vertex( __u32 __v ) { _M_out.push_back( __v ); }
+      };
+//--------------------------------------------------------------------
+// Посетитель, собирающий вершины в порядке закрытия.
+    struct postorder_visitor : pdfs_visitor
+      {
+      std::vector<__u32>&  _M_out;
+
+      void finish_vertex( __u32 __v ) { _M_out.push_back( __v ); }
+      };
+//--------------------------------------------------------------------
+// Посетитель топологической сортировки: порядок закрытия и
+// признак найденного цикла.
+    struct topological_visitor : pdfs_visitor
+      {
+      std::vector<__u32>&  _M_out;
+      bool                 _M_cycle;
+
+      void finish_vertex( __u32 __v ) { _M_out.push_back( __v ); }
+      void back_edge( __u32, __u32 ) { _M_cycle = true; }
+      };
+    } // namespace __detail
+//--------------------------------------------------------------------
+// Обход графа в ширину от заданной вершины.
+// Возвращает расстояние в ребрах до каждой вершины, для
+// недостижимых - 0xFFFFFFFF. Вектор результата служит и очередью.
+  template <typename _Graph>
+    auto
+    bfs_levels( const _Graph& __g, __u32 __start ) -> std::vector<__u32>
+      {
+      std::vector<__u32>  __level( __g.vertex_bound(), 0xFFFFFFFFu );
+      std::vector<__u32>  __queue;
+
+      __level[__start] = 0;
+      __queue.push_back( __start );
+
+      for( __u64 __head{ 0 }; __head < __queue.size(); __head++ )
+        {
+        __u32  __v = __queue[__head];
+
+        for( auto __c = __g.adj_begin( __v );
+             __c != __g.adj_end( __v );
+             __c = __g.adj_next( __v, __c ) )
+          {
+          __u32  __w = __g.adj_target( __v, __c );
+          if( __level[__w] == 0xFFFFFFFFu )
+            {
+            __level[__w] = __level[__v] + 1;
+            __queue.push_back( __w );
+            }
+          }
+        }
+
+      return __level;
+      }
+//--------------------------------------------------------------------
+// Обход графа в глубину от заданной вершины.
+// Глубина обхода ограничена только памятью, а не стеком вызовов.
+  template <typename _Graph, typename _Visitor>
+    auto
+    dfs( const _Graph& __g, __u32 __start, _Visitor& __vis ) -> void
+      {
+      std::vector<__u8>  __color( __g.vertex_bound(), __detail::__white );
+      __detail::dfs_from( __g, __start, __vis, __color );
+      }
+//--------------------------------------------------------------------
+// Обход графа в глубину, начиная из каждой еще не посещенной
+// вершины в порядке возрастания номеров.
+  template <typename _Graph, typename _Visitor>
+    auto
+    dfs_all( const _Graph& __g, _Visitor& __vis ) -> void
+      {
+      __u32              __n{ __g.vertex_bound() };
+      std::vector<__u8>  __color( __n, __detail::__white );
+
+      for( __u32 __i{ 0 }; __i < __n; __i++ )
+        {
+        if( __color[__i] == __detail::__white )
+          { __detail::dfs_from( __g, __i, __vis, __color ); }
+        }
+      }
+//--------------------------------------------------------------------
+// Вершины, достижимые из __start, в порядке открытия.
+  template <typename _Graph>
+    auto
+    dfs_preorder( const _Graph& __g, __u32 __start ) -> std::vector<__u32>
+      {
+      std::vector<__u32>          __out;
+      __detail::preorder_visitor  __vis{ { }, __out };
+
+      dfs( __g, __start, __vis );
+      return __out;
+      }
+//--------------------------------------------------------------------
+// Вершины, достижимые из __start, в порядке закрытия.
+  template <typename _Graph>
+    auto
+    dfs_postorder( const _Graph& __g, __u32 __start ) -> std::vector<__u32>
+      {
+      std::vector<__u32>           __out;
+      __detail::postorder_visitor  __vis{ { }, __out };
+
+      dfs( __g, __start, __vis );
+      return __out;
+      }
+//--------------------------------------------------------------------
+// Топологическая сортировка ориентированного графа: обратный
+// порядок закрытия вершин. Для графа с циклом бросает исключение.
+  template <typename _Graph>
+    auto
+    topological_sort( const _Graph& __g ) -> std::vector<__u32>
+      {
+      std::vector<__u32>             __out;
+      __detail::topological_visitor  __vis{ { }, __out, false };
+
+      __out.reserve( __g.vertex_bound() );
+      dfs_all( __g, __vis );
+
+      if( __vis._M_cycle )
+        { throw pexception( "E: Граф содержит цикл." ); }
+
+      std::reverse( __out.begin(), __out.end() );
+      return __out;
+      }
+
+  namespace __detail
+    {
+//--------------------------------------------------------------------
+// Алгоритм Кана: вершины с нулевой полустепенью захода выводятся по
+// очереди, их исходящие ребра удаляются. Вершины на циклах так и не
+// получают нулевую полустепень и в результат не попадают.
+    template <typename _Graph>
+      auto
+      kahn_order( const _Graph& __g ) -> std::vector<__u32>
+        {
+        __u32               __n{ __g.vertex_bound() };
+        std::vector<__u32>  __in( __n, 0 );
+        std::vector<__u32>  __out;
+
+        for( __u32 __v{ 0 }; __v < __n; __v++ )
+          {
+          for( auto __c = __g.adj_begin( __v );
+               __c != __g.adj_end( __v );
+               __c = __g.adj_next( __v, __c ) )
+            { __in[__g.adj_target( __v, __c )]++; }
+          }
+
+        __out.reserve( __n );
+        for( __u32 __v{ 0 }; __v < __n; __v++ )
+          {
+          if( __in[__v] == 0 )
+            { __out.push_back( __v ); }
+          }
+
+        /** Результат служит и очередью: голова - __head.
+         */
+        for( __u64 __head{ 0 }; __head < __out.size(); __head++ )
+          {
+          __u32  __v = __out[__head];
+
+          for( auto __c = __g.adj_begin( __v );
+               __c != __g.adj_end( __v );
+               __c = __g.adj_next( __v, __c ) )
+            {
+            __u32  __w = __g.adj_target( __v, __c );
+            if( --__in[__w] == 0 )
+              { __out.push_back( __w ); }
+            }
+          }
+
+        return __out;
+        }
+    } // namespace __detail
+//--------------------------------------------------------------------
+// Топологическая сортировка ориентированного графа алгоритмом Кана.
+// Для графа с циклом бросает исключение.
+  template <typename _Graph>
+    auto
+    kahn_sort( const _Graph& __g ) -> std::vector<__u32>
+      {
+      std::vector<__u32>  __out = __detail::kahn_order( __g );
+
+      if( __out.size() != __g.vertex_bound() )
+        { throw pexception( "E: Граф содержит цикл." ); }
+
+      return __out;
+      }
+//--------------------------------------------------------------------
+// Проверка ориентированного графа на отсутствие циклов.
+  template <typename _Graph>
+    auto
+    is_acyclic( const _Graph& __g ) -> bool
+      { return __detail::kahn_order( __g ).size() == __g.vertex_bound(); }
+
+  } // namespace ptl
+
+#endif // __PTL_PTRAVERSAL_H__
@@ -18,148 +18,579 @@
 #include "ptype.h"
 #endif
 
+#if !defined( __PTL_PEXCEPT_H__ )
+#include "pexcept.h"
+#endif
+
+#if !defined( __PTL_PPARALLEL_H__ )
+#include "pparallel.h"
+#endif
+
+#include <condition_variable>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 /*
- * Дерево. 
+ * Дерево.
+ *
+ * Вершины лежат в одном массиве (арене) и адресуются 32-битными
+ * индексами. Дети вершины - двусвязный список братьев: у вершины есть
+ * первый и последний ребенок, у ребенка - предыдущий и следующий брат.
+ * Количество детей не ограничено, вставка и удаление ребенка - O(1).
+ * Освободившиеся ячейки арены используются повторно.
  *
  * Методы:
- *   - ptree::Node::add_child() - добавление в массив детей узла нового элемента
- *   - ptree::Node::del_child() - удаление дочернего узла из Node
  *   - set_root() - установка корневого узла
  *   - add_node() - добавление нового узла дерева
- *   - get_node_by_number() - поиск вершины Node по ее номеру
+ *   - get_node_by_number() - поиск вершины по ее номеру
+ *   - is_exists_node() - проверка наличия вершины с номером
  *   - del_node() - удаление узла из дерева
+ *   - size() - количество вершин дерева
+ *   - reserve() - резервирование памяти под количество вершин
+ *   - root() - индекс корня
+ *   - number(), parent(), child_count() - номер, родитель и количество
+ *     детей вершины
+ *   - first_child(), last_child(), next_sibling(), prev_sibling() -
+ *     связи вершины
+ *   - for_each_child() - обход детей вершины
+ *   - node_bound() - граница индексов вершин (размер арены)
+ *   - version() - номер версии, растет при каждом изменении дерева
+ *   - preorder(), postorder(), level_order() - обход поддерева с
+ *     вызовом посетителя для каждой вершины
+ *   - parallel_reduce() - параллельная свертка значений по поддереву
+ *     на пуле потоков ptask_pool или на временном пуле
+ *
+ * Все обходы итеративные: прямой и обратный идут по связям вершин
+ * без стека, поэтому глубина дерева не ограничена размером стека.
+ *
+ * Дерево хранит хеш-индекс "номер -> вершина", поэтому поиск,
+ * добавление и удаление вершины по номеру - O(1) в среднем.
+ * Номера вершин уникальны. Вершина без связи - ptree::npos.
+ *
+ * @code
+ *   ptl::ptree tree;
+ *   tree.set_root( 1 );
+ *   tree.add_node( 1, 2 );
+ *   tree.for_each_child( tree.root(), [&]( ptl::__u32 c )
+ *     { std::cout << tree.number( c ); } );
+ * @endcode
  */
 
-#define SIZE 10
-
 namespace ptl
   {
 //////////////////////////////////////////////////////////////////////
   class ptree
     {
-    struct Node // структура узла дерева
-      {
-      Node( __s32 _number, Node* _parent = nullptr )
-        : _S_number( _number ),
-          _S_parent( _parent ),
-          _S_childCount( 0 )
-        { }
-
-      ~Node()
+    public:
+      static constexpr __u32  npos = 0xFFFFFFFFu; // Нет вершины
+
+    private:
+      struct Node // структура узла дерева
         {
-        for( __s32 i{0}; i < _S_childCount; i++ )
-          { delete _S_children[ i ]; }
-        }
+        __s32  _S_number;       // номер вершины дерева
+        __u32  _S_parent;       // родительская вершина
+        __u32  _S_first_child;  // первый ребенок
+        __u32  _S_last_child;   // последний ребенок
+        __u32  _S_prev_sibling; // предыдущий брат
+        __u32  _S_next_sibling; // следующий брат (в свободной ячейке -
+                                // следующая свободная)
+        __u32  _S_child_count;  // количество детей
+        };
 
-      __s32  _S_number;           // номер вершины дерева
+      std::vector<Node>                 _M_nodes;          // арена вершин
+      __u32                             _M_root{ npos };   // корень
+      __u32                             _M_free{ npos };   // свободные ячейки
+      std::unordered_map<__s32, __u32>  _M_index;          // номер -> вершина
+      __u64                             _M_version{ 0 };   // номер изменения
 
-      Node*  _S_parent;           // указатель на родительскую вершину дерева
-      Node*  _S_children[ SIZE ]; // список указателей дочерних вершин дерева
-      __s32  _S_childCount;       // количество детей дерева
-//--------------------------------------------------------------------
-// Добавление в массив детей узла нового элемента.
-      auto
-      add_child( Node* _newChild ) -> void
-        { _S_children[ _S_childCount++ ] = _newChild; }
 //--------------------------------------------------------------------
-// Удаление дочернего узла из Node.
+      // Ячейка арены под новую вершину.
       auto
-      del_child( Node* _child ) -> void
+      alloc_node( __s32 _number, __u32 _parent ) -> __u32
         {
-        __s32  _foundIndex = -1;
+        __u32  _idx;
 
-        for( __s32 i{0}; i < _S_childCount; i++ )
+        if( _M_free != npos )
+          {
+          _idx    = _M_free;
+          _M_free = _M_nodes[ _idx ]._S_next_sibling;
+          }
+        else
           {
-          if( _S_children[ i ] == _child )
-            // нашли индекс удаляемой вершины в массиве
-            { _foundIndex = i; }
+          if( _M_nodes.size() >= npos )
+            { throw pexception( "E: Слишком много вершин." ); }
+          _idx = static_cast<__u32>( _M_nodes.size() );
+          _M_nodes.emplace_back();
           }
 
-        delete _S_children[ _foundIndex ]; // удалили вершину
+        _M_nodes[ _idx ] = Node{ _number, _parent, npos, npos, npos, npos, 0 };
+        return _idx;
+        }
+//--------------------------------------------------------------------
+      auto
+      free_node( __u32 _idx ) -> void
+        {
+        _M_nodes[ _idx ]._S_next_sibling = _M_free;
+        _M_free = _idx;
+        }
+//--------------------------------------------------------------------
+      // Вершина по номеру из индекса; исключение, если ее нет.
+      auto
+      find_node( __s32 _number ) const -> __u32
+        {
+        auto  _it = _M_index.find( _number );
+        if( _it == _M_index.end() )
+          { throw pexception( "E: Вершины с таким номером нет." ); }
+        return _it->second;
+        }
+//--------------------------------------------------------------------
+      // Добавление _child в конец списка детей _parent.
+      auto
+      link_child( __u32 _parent, __u32 _child ) -> void
+        {
+        Node&  _p = _M_nodes[ _parent ];
+        Node&  _c = _M_nodes[ _child ];
 
-        _S_childCount--; // удалили ее из массива
+        _c._S_parent       = _parent;
+        _c._S_prev_sibling = _p._S_last_child;
+        _c._S_next_sibling = npos;
 
-        for( __s32 i{_foundIndex}; i < _S_childCount; i++ )
-          { _S_children[ i ] = _S_children[ i + 1 ]; }
+        if( _p._S_last_child != npos )
+          { _M_nodes[ _p._S_last_child ]._S_next_sibling = _child; }
+        else
+          { _p._S_first_child = _child; }
+
+        _p._S_last_child = _child;
+        _p._S_child_count++;
         }
-      };
+//--------------------------------------------------------------------
+      // Исключение _child из списка детей его родителя.
+      auto
+      unlink_child( __u32 _child ) -> void
+        {
+        Node&  _c = _M_nodes[ _child ];
+        Node&  _p = _M_nodes[ _c._S_parent ];
 
-    private:
-      Node*  _M_root;             // указатель на корневую вершину дерева
+        if( _c._S_prev_sibling != npos )
+          { _M_nodes[ _c._S_prev_sibling ]._S_next_sibling = _c._S_next_sibling; }
+        else
+          { _p._S_first_child = _c._S_next_sibling; }
 
-    public:
-      ptree()
-        { _M_root = nullptr; }
+        if( _c._S_next_sibling != npos )
+          { _M_nodes[ _c._S_next_sibling ]._S_prev_sibling = _c._S_prev_sibling; }
+        else
+          { _p._S_last_child = _c._S_prev_sibling; }
 
-      ~ptree()
-        {
-        if( _M_root != nullptr )
-          { delete _M_root; }
+        _p._S_child_count--;
         }
 //--------------------------------------------------------------------
-// Установка корневого узла дерева.
+      // Следующая за _v вершина прямого обхода поддерева _start
+      // или npos.
       auto
-      set_root( __s32 _number ) -> void
+      next_preorder( __u32 _v, __u32 _start ) const -> __u32
         {
-        if( _M_root != nullptr )
+        if( _M_nodes[ _v ]._S_first_child != npos )
+          { return _M_nodes[ _v ]._S_first_child; }
+
+        while( _v != _start )
           {
-          // удаляем корень, если он был
-          delete _M_root;
-          _M_root = nullptr;
+          if( _M_nodes[ _v ]._S_next_sibling != npos )
+            { return _M_nodes[ _v ]._S_next_sibling; }
+          _v = _M_nodes[ _v ]._S_parent;
           }
 
-        _M_root = new Node( _number ); // устанавливаем новый корень
+        return npos;
         }
 //--------------------------------------------------------------------
-// Добавление нового узла дерева.
+      // Самый левый лист поддерева _v - первая вершина обратного обхода.
       auto
-      add_node( __s32 _parentNumber, __s32 _newNodeNumber ) -> void
+      leftmost_leaf( __u32 _v ) const -> __u32
         {
-        // нашли родителя
-        Node*  _parentNode = get_node_by_number( _parentNumber, _M_root );
-        // создали новую вершину
-        Node*  _newNode    = new Node( _newNodeNumber, _parentNode );
+        while( _M_nodes[ _v ]._S_first_child != npos )
+          { _v = _M_nodes[ _v ]._S_first_child; }
+        return _v;
+        }
+//--------------------------------------------------------------------
+      // Следующая за _v вершина обратного обхода поддерева _start
+      // или npos.
+      auto
+      next_postorder( __u32 _v, __u32 _start ) const -> __u32
+        {
+        if( _v == _start )
+          { return npos; }
+        if( _M_nodes[ _v ]._S_next_sibling != npos )
+          { return leftmost_leaf( _M_nodes[ _v ]._S_next_sibling ); }
+        return _M_nodes[ _v ]._S_parent;
+        }
+
+    public:
+      ptree() = default;
+
+      ~ptree() = default;
+//--------------------------------------------------------------------
+// Установка корневого узла дерева. Прежнее дерево удаляется.
+      auto
+      set_root( __s32 _number ) -> void
+        {
+        _M_nodes.clear();
+        _M_index.clear();
+        _M_free = npos;
+        _M_version++;
 
-        // добавили к родителю
-        _parentNode->add_child( _newNode );
+        _M_root = alloc_node( _number, npos ); // устанавливаем новый корень
+        _M_index.emplace( _number, _M_root );
         }
 //--------------------------------------------------------------------
-// Поиск вершины Node по ее номеру.
-      auto 
-      get_node_by_number( __s32 _number, Node* _current ) -> Node*
+// Добавление нового узла дерева. Возвращает индекс вершины.
+      auto
+      add_node( __s32 _parentNumber, __s32 _newNodeNumber ) -> __u32
         {
-        if( _current->_S_number == _number )
-          // если нашли вершину с нужным узлом, возвращаем
-          { return _current; }
+        // нашли родителя
+        __u32  _parentNode = find_node( _parentNumber );
 
-        for( __s32 i{0}; i < _current->_S_childCount; i++ )
+        if( _M_index.count( _newNodeNumber ) != 0 )
+          { throw pexception( "E: Вершина с таким номером уже есть." ); }
+
+        // создали новую вершину и добавили к родителю и в индекс
+        __u32  _newNode = alloc_node( _newNodeNumber, _parentNode );
+        link_child( _parentNode, _newNode );
+        _M_index.emplace( _newNodeNumber, _newNode );
+        _M_version++;
+        return _newNode;
+        }
+//--------------------------------------------------------------------
+// Поиск вершины по ее номеру через индекс.
+// Возвращает npos, если вершины нет.
+      auto
+      get_node_by_number( __s32 _number ) const -> __u32
+        {
+        auto  _it = _M_index.find( _number );
+        return _it == _M_index.end() ? npos : _it->second;
+        }
+//--------------------------------------------------------------------
+      auto
+      is_exists_node( __s32 _number ) const -> bool
+        { return _M_index.count( _number ) != 0; }
+//--------------------------------------------------------------------
+// Количество вершин дерева.
+      auto
+      size() const -> __u64
+        { return _M_index.size(); }
+//--------------------------------------------------------------------
+// Резервирование арены и индекса под _count вершин.
+      auto
+      reserve( __u64 _count ) -> void
+        {
+        _M_nodes.reserve( _count );
+        _M_index.reserve( _count );
+        }
+//--------------------------------------------------------------------
+// Поиск вершины по ее номеру в поддереве _current обходом.
+      auto
+      get_node_by_number( __s32 _number, __u32 _current ) const -> __u32
+        {
+        // обходим в глубину, пока не найдем искомую
+        for( __u32 _v = _current; _v != npos; _v = next_preorder( _v, _current ) )
           {
-          // обходим в глубину, пока не найдем искомую
-          Node*  _found = get_node_by_number( _number, 
-                                              _current->_S_children[ i ] );
-          if( _found )
-            { return _found; }
+          if( _M_nodes[ _v ]._S_number == _number )
+            { return _v; }
           }
 
-        return nullptr;
+        return npos;
         }
 //--------------------------------------------------------------------
-// Удаление узла из дерева.
+// Удаление узла из дерева. Дети удаляемой вершины переходят к ее
+// родителю и становятся в конец списка его детей.
       auto
       del_node( __s32 _number ) -> void
         {
         // нашли вершину для удаления
-        Node*  _node   = get_node_by_number( _number, _M_root );
+        __u32  _node   = find_node( _number );
+        __u32  _parent = _M_nodes[ _node ]._S_parent;
+
+        if( _parent == npos )
+          { throw pexception( "E: Корень дерева удаляется через set_root()." ); }
+
+        unlink_child( _node );
 
         // перебросили всех детей удаляемой вершины ее родителю
-        for( __s32 i{0}; i < _node->_S_childCount; i++ )
-          { _node->_S_parent->add_child( _node->_S_children[ i ] ); }
+        Node&  _n = _M_nodes[ _node ];
+        if( _n._S_first_child != npos )
+          {
+          for( __u32 _c = _n._S_first_child; _c != npos; _c = _M_nodes[ _c ]._S_next_sibling )
+            { _M_nodes[ _c ]._S_parent = _parent; }
+
+          Node&  _p = _M_nodes[ _parent ];
+          _M_nodes[ _n._S_first_child ]._S_prev_sibling = _p._S_last_child;
+          if( _p._S_last_child != npos )
+            { _M_nodes[ _p._S_last_child ]._S_next_sibling = _n._S_first_child; }
+          else
+            { _p._S_first_child = _n._S_first_child; }
+          _p._S_last_child   = _n._S_last_child;
+          _p._S_child_count += _n._S_child_count;
+          }
 
-        // указатели, что у удаляемой вершины, больше нет детей
-        _node->_S_childCount = 0;
         // удалить вершину
-        _node->_S_parent->del_child( _node );
+        _M_index.erase( _number );
+        free_node( _node );
+        _M_version++;
         }
+//--------------------------------------------------------------------
+      auto
+      root() const -> __u32
+        { return _M_root; }
+//--------------------------------------------------------------------
+// Граница индексов вершин: все индексы меньше node_bound().
+      auto
+      node_bound() const -> __u32
+        { return static_cast<__u32>( _M_nodes.size() ); }
+//--------------------------------------------------------------------
+// Номер версии дерева. По нему построенные над деревом индексы
+// (ptree_index) узнают, что дерево изменилось.
+      auto
+      version() const -> __u64
+        { return _M_version; }
+//--------------------------------------------------------------------
+      auto
+      number( __u32 _node ) const -> __s32
+        { return _M_nodes[ _node ]._S_number; }
+//--------------------------------------------------------------------
+      auto
+      parent( __u32 _node ) const -> __u32
+        { return _M_nodes[ _node ]._S_parent; }
+//--------------------------------------------------------------------
+      auto
+      child_count( __u32 _node ) const -> __u32
+        { return _M_nodes[ _node ]._S_child_count; }
+//--------------------------------------------------------------------
+      auto
+      first_child( __u32 _node ) const -> __u32
+        { return _M_nodes[ _node ]._S_first_child; }
+//--------------------------------------------------------------------
+      auto
+      last_child( __u32 _node ) const -> __u32
+        { return _M_nodes[ _node ]._S_last_child; }
+//--------------------------------------------------------------------
+      auto
+      next_sibling( __u32 _node ) const -> __u32
+        { return _M_nodes[ _node ]._S_next_sibling; }
+//--------------------------------------------------------------------
+      auto
+      prev_sibling( __u32 _node ) const -> __u32
+        { return _M_nodes[ _node ]._S_prev_sibling; }
+//--------------------------------------------------------------------
+// Вызов _f( child ) для каждого ребенка вершины _node по порядку.
+      template <typename _Func>
+        auto
+        for_each_child( __u32 _node, _Func _f ) const -> void
+          {
+          for( __u32 _c = _M_nodes[ _node ]._S_first_child;
+               _c != npos; _c = _M_nodes[ _c ]._S_next_sibling )
+            { _f( _c ); }
+          }
+//--------------------------------------------------------------------
+// Прямой обход поддерева _start: вершина раньше своих детей.
+      template <typename _Func>
+        auto
+        preorder( __u32 _start, _Func _f ) const -> void
+          {
+          for( __u32 _v = _start; _v != npos; _v = next_preorder( _v, _start ) )
+            { _f( _v ); }
+          }
+//--------------------------------------------------------------------
+// Обратный обход поддерева _start: вершина после своих детей.
+      template <typename _Func>
+        auto
+        postorder( __u32 _start, _Func _f ) const -> void
+          {
+          if( _start == npos )
+            { return; }
+
+          for( __u32 _v = leftmost_leaf( _start ); _v != npos; )
+            {
+            /** Следующая вычисляется до посещения: посетителю
+             *  разрешено читать связи, но не менять дерево.
+             */
+            __u32  _next = next_postorder( _v, _start );
+            _f( _v );
+            _v = _next;
+            }
+          }
+//--------------------------------------------------------------------
+// Обход поддерева _start по уровням (в ширину).
+      template <typename _Func>
+        auto
+        level_order( __u32 _start, _Func _f ) const -> void
+          {
+          if( _start == npos )
+            { return; }
+
+          std::vector<__u32>  _queue{ _start };
+
+          for( __u64 _head{ 0 }; _head < _queue.size(); _head++ )
+            {
+            __u32  _v = _queue[ _head ];
+            _f( _v );
+            for_each_child( _v, [&]( __u32 _c ) { _queue.push_back( _c ); } );
+            }
+          }
+//--------------------------------------------------------------------
+// Параллельная свертка по поддереву _start: результат -
+// _combine( ... _combine( _identity, _map( v ) ) ... ) по всем
+// вершинам в неопределенном порядке, поэтому _combine должна быть
+// ассоциативной и коммутативной, а _identity - ее нейтральным
+// элементом. _map( v ) вызывается одновременно из нескольких потоков.
+//
+// Сначала одним обратным обходом считаются размеры поддеревьев.
+// Поддерево не больше _grain вершин обходится одним потоком; у
+// большего вершина обрабатывается сразу, а ее дети группируются в
+// задачи примерно по _grain вершин и раздаются свободным потокам.
+// Работают потоки пула _pool: при частых свертках пул создается один
+// раз, а не на каждый вызов.
+      template <typename _Val, typename _Map, typename _Combine>
+        auto
+        parallel_reduce( __u32 _start, _Val _identity, _Map _map,
+                         _Combine _combine, ptask_pool& _pool,
+                         __u32 _grain = 4096 ) const -> _Val
+          {
+          if( _start == npos )
+            { return _identity; }
+
+          std::vector<__u32>  _size( _M_nodes.size(), 0 );
+          postorder( _start, [&]( __u32 _v )
+            {
+            _size[ _v ]++;
+            if( _v != _start )
+              { _size[ _M_nodes[ _v ]._S_parent ] += _size[ _v ]; }
+            } );
+
+          if( _grain == 0 )
+            { _grain = 1; }
+
+          auto _fold = [&]( __u32 _root, _Val& _acc )
+            {
+            for( __u32 _v = _root; _v != npos; _v = next_preorder( _v, _root ) )
+              { _acc = _combine( _acc, _map( _v ) ); }
+            };
+
+          if( _pool.size() <= 1 || _size[ _start ] <= _grain )
+            {
+            _Val  _acc = _identity;
+            _fold( _start, _acc );
+            return _acc;
+            }
+
+          /** Задача - _S_count братьев подряд, начиная с _S_first.
+           */
+          struct _Task
+            {
+            __u32  _S_first;
+            __u32  _S_count;
+            };
+
+          std::mutex               _mutex;
+          std::condition_variable  _wake;
+          std::vector<_Task>       _shared{ _Task{ _start, 1 } };
+          __u64                    _pending{ 1 }; // Выданные и незавершенные
+
+          // Поток копит свертку в локальной переменной и записывает
+          // ее в _out только в конце - без ложного разделения строк.
+          auto _work = [&]( _Val& _out )
+            {
+            std::vector<_Task>  _local;
+            _Val                _acc = _identity;
+
+            for( ;; )
+              {
+                {
+                std::unique_lock<std::mutex>  _lock( _mutex );
+                _wake.wait( _lock, [&] { return !_shared.empty() || _pending == 0; } );
+                if( _shared.empty() )
+                  {
+                  _out = _acc;
+                  return;
+                  }
+                _local.push_back( _shared.back() );
+                _shared.pop_back();
+                }
+
+              while( !_local.empty() )
+                {
+                _Task  _task = _local.back();
+                _local.pop_back();
+
+                __u32  _s = _task._S_first;
+                for( __u32 _i{ 0 }; _i < _task._S_count; _i++, _s = _M_nodes[ _s ]._S_next_sibling )
+                  {
+                  if( _size[ _s ] <= _grain )
+                    {
+                    _fold( _s, _acc );
+                    continue;
+                    }
+
+                  _acc = _combine( _acc, _map( _s ) );
+
+                  /** Дети большой вершины - пачками примерно по
+                   *  _grain вершин; последняя пачка остается этому
+                   *  потоку, остальные отдаются другим.
+                   */
+                  _Task  _batch{ _M_nodes[ _s ]._S_first_child, 0 };
+                  __u64  _weight{ 0 };
+
+                  for( __u32 _c = _batch._S_first; _c != npos; _c = _M_nodes[ _c ]._S_next_sibling )
+                    {
+                    _batch._S_count++;
+                    _weight += _size[ _c ];
+
+                    if( _weight >= _grain && _M_nodes[ _c ]._S_next_sibling != npos )
+                      {
+                        {
+                        std::lock_guard<std::mutex>  _lock( _mutex );
+                        _shared.push_back( _batch );
+                        _pending++;
+                        }
+                      _wake.notify_one();
+
+                      _batch  = _Task{ _M_nodes[ _c ]._S_next_sibling, 0 };
+                      _weight = 0;
+                      }
+                    }
+
+                  _local.push_back( _batch );
+                  }
+                }
+
+              bool  _done;
+                {
+                std::lock_guard<std::mutex>  _lock( _mutex );
+                _done = --_pending == 0;
+                }
+              if( _done )
+                { _wake.notify_all(); }
+              }
+            };
+
+          std::vector<_Val>  _partial( _pool.size(), _identity );
+          auto _job = [&]( __u32 _worker ) { _work( _partial[ _worker ] ); };
+          _pool.run( _job );
+
+          _Val  _result = _identity;
+          for( const _Val& _p : _partial )
+            { _result = _combine( _result, _p ); }
+          return _result;
+          }
+//--------------------------------------------------------------------
+// Параллельная свертка на временном пуле из _threads потоков.
+      template <typename _Val, typename _Map, typename _Combine>
+        auto
+        parallel_reduce( __u32 _start, _Val _identity, _Map _map,
+                         _Combine _combine, __u32 _threads = hardware_threads(),
+                         __u32 _grain = 4096 ) const -> _Val
+          {
+          ptask_pool  _pool( _threads );
+          return parallel_reduce( _start, _identity, _map, _combine, _pool, _grain );
+          }
 
     }; // class ptree
   } // namespace ptl
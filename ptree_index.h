@@ -0,0 +1,290 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для индекса дерева по эйлерову обходу.
+ */
+
+/**
+ *  (PTL) Patriarch library : ptree_index.h
+ */
+
+#pragma once
+#if !defined( __PTL_PTREE_INDEX_H__ )
+#define __PTL_PTREE_INDEX_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#if !defined( __PTL_PEXCEPT_H__ )
+#include "pexcept.h"
+#endif
+
+#if !defined( __PTL_PTREE_H__ )
+#include "ptree.h"
+#endif
+
+#include <utility>
+#include <vector>
+
+/*
+ * Индекс над ptree, построенный одним обходом в глубину. Каждой
+ * вершине сопоставлен отрезок [tin, tout] номеров прямого обхода;
+ * поддерево вершины - ровно вершины с номерами из ее отрезка.
+ *
+ *   - предок: a - предок b, если отрезок b вложен в отрезок a, O(1);
+ *   - наименьший общий предок: для tin[u] < tin[v] это родитель
+ *     вершины с наименьшим tin среди родителей вершин с номерами
+ *     обхода (tin[u], tin[v]]; минимум на отрезке - разреженная
+ *     таблица, O(1) на запрос, O(n log n) памяти;
+ *   - сумма по поддереву: дерево Фенвика над номерами обхода,
+ *     O(log n) на запрос и изменение значения.
+ *
+ * Индекс запоминает версию дерева (ptree::version()) при построении.
+ * После add_node(), del_node() или set_root() индекс устаревает:
+ * запросы к нему бросают исключение до вызова rebuild().
+ *
+ * Методы:
+ *   - rebuild() - построение индекса заново
+ *   - is_valid() - индекс соответствует текущему дереву
+ *   - is_ancestor() - проверка, что a - предок b (или a == b)
+ *   - lca() - наименьший общий предок двух вершин
+ *   - subtree_size() - количество вершин поддерева
+ *   - set_value(), add_value(), value() - значение вершины
+ *   - subtree_sum() - сумма значений по поддереву
+ *
+ * Вершины задаются номерами, как в ptree.
+ *
+ * @code
+ *   ptl::ptree_index<ptl::__s64> index( tree );
+ *   index.set_value( 7, 100 );
+ *   if( index.is_ancestor( 1, 7 ) ) { ... }
+ *   ptl::__s32 boss = index.lca( 7, 9 );
+ *   ptl::__s64 total = index.subtree_sum( 1 );
+ * @endcode
+ */
+
+namespace ptl
+  {
+//////////////////////////////////////////////////////////////////////
+  template <typename _Val = __s64>
+  class ptree_index
+    {
+    private:
+      const ptree*                     _M_tree;
+      __u64                            _M_version{ 0 };
+      std::vector<__u32>               _M_tin;    // индекс вершины -> номер обхода
+      std::vector<__u32>               _M_tout;   // последний номер поддерева
+      std::vector<__u32>               _M_order;  // номер обхода -> индекс вершины
+      std::vector<std::vector<__u32>>  _M_sparse; // минимумы родителей по tin
+      std::vector<_Val>                _M_fenwick;
+
+      // Из двух вершин - с меньшим номером обхода.
+      auto
+      earlier( __u32 __a, __u32 __b ) const -> __u32
+        { return _M_tin[__a] < _M_tin[__b] ? __a : __b; }
+//--------------------------------------------------------------------
+      // Индекс вершины по номеру с проверкой актуальности индекса.
+      auto
+      node( __s32 __number ) const -> __u32
+        {
+        if( !is_valid() )
+          { throw pexception( "E: Индекс дерева устарел, нужен rebuild()." ); }
+
+        __u32  __v = _M_tree->get_node_by_number( __number );
+        if( __v == ptree::npos )
+          { throw pexception( "E: Вершины с таким номером нет." ); }
+        return __v;
+        }
+//--------------------------------------------------------------------
+      // Прямой обход без стека: по первому ребенку вниз, по брату
+      // вбок, по родителю вверх.
+      auto
+      build_order() -> void
+        {
+        const ptree&  __t = *_M_tree;
+
+        _M_tin.assign( __t.node_bound(), ptree::npos );
+        _M_tout.assign( __t.node_bound(), ptree::npos );
+        _M_order.clear();
+        _M_order.reserve( __t.size() );
+
+        __u32  __v = __t.root();
+        while( __v != ptree::npos )
+          {
+          _M_tin[__v] = static_cast<__u32>( _M_order.size() );
+          _M_order.push_back( __v );
+
+          if( __t.first_child( __v ) != ptree::npos )
+            {
+            __v = __t.first_child( __v );
+            continue;
+            }
+
+          /** Лист: закрываем вершины, пока не найдется брат.
+           */
+          for( ;; )
+            {
+            _M_tout[__v] = static_cast<__u32>( _M_order.size() - 1 );
+
+            if( __t.next_sibling( __v ) != ptree::npos )
+              {
+              __v = __t.next_sibling( __v );
+              break;
+              }
+
+            __v = __t.parent( __v );
+            if( __v == ptree::npos )
+              { break; }
+            }
+          }
+        }
+//--------------------------------------------------------------------
+      // Уровень 0 - родитель вершины с номером обхода i; уровень k -
+      // минимум по tin на отрезке [i, i + 2^k).
+      auto
+      build_sparse() -> void
+        {
+        __u32  __n = static_cast<__u32>( _M_order.size() );
+
+        _M_sparse.clear();
+        _M_sparse.emplace_back( __n );
+        for( __u32 __i{ 1 }; __i < __n; __i++ )
+          { _M_sparse[0][__i] = _M_tree->parent( _M_order[__i] ); }
+
+        for( __u32 __k{ 1 }; ( 1u << __k ) <= __n; __k++ )
+          {
+          const std::vector<__u32>&  __prev = _M_sparse[__k - 1];
+          std::vector<__u32>         __level( __n - ( 1u << __k ) + 1 );
+
+          for( __u32 __i{ 0 }; __i < __level.size(); __i++ )
+            { __level[__i] = earlier( __prev[__i], __prev[__i + ( 1u << ( __k - 1 ) )] ); }
+
+          _M_sparse.push_back( std::move( __level ) );
+          }
+        }
+//--------------------------------------------------------------------
+      // Сумма значений вершин с номерами обхода [0, __count).
+      auto
+      prefix_sum( __u32 __count ) const -> _Val
+        {
+        _Val  __sum = _Val();
+        for( __u32 __i = __count; __i > 0; __i -= __i & ( 0u - __i ) )
+          { __sum += _M_fenwick[__i]; }
+        return __sum;
+        }
+
+    public:
+      explicit
+      ptree_index( const ptree& __tree )
+        : _M_tree( &__tree )
+        { rebuild(); }
+//--------------------------------------------------------------------
+// Построение индекса по текущему дереву. Значения вершин
+// сбрасываются в _Val().
+      auto
+      rebuild() -> void
+        {
+        build_order();
+        build_sparse();
+        _M_fenwick.assign( _M_order.size() + 1, _Val() );
+        _M_version = _M_tree->version();
+        }
+//--------------------------------------------------------------------
+// Построение индекса с начальными значениями __f( number ) за O(n).
+      template <typename _Func>
+        auto
+        rebuild( _Func __f ) -> void
+          {
+          rebuild();
+
+          __u32  __n = static_cast<__u32>( _M_order.size() );
+          for( __u32 __i{ 1 }; __i <= __n; __i++ )
+            {
+            _M_fenwick[__i] += __f( _M_tree->number( _M_order[__i - 1] ) );
+
+            __u32  __up = __i + ( __i & ( 0u - __i ) );
+            if( __up <= __n )
+              { _M_fenwick[__up] += _M_fenwick[__i]; }
+            }
+          }
+//--------------------------------------------------------------------
+      auto
+      is_valid() const -> bool
+        { return _M_version == _M_tree->version(); }
+//--------------------------------------------------------------------
+// Проверка, что __a - предок __b (вершина - предок самой себя).
+      auto
+      is_ancestor( __s32 __a, __s32 __b ) const -> bool
+        {
+        __u32  __u = node( __a );
+        __u32  __v = node( __b );
+        return _M_tin[__u] <= _M_tin[__v] && _M_tout[__v] <= _M_tout[__u];
+        }
+//--------------------------------------------------------------------
+// Наименьший общий предок вершин __a и __b.
+      auto
+      lca( __s32 __a, __s32 __b ) const -> __s32
+        {
+        __u32  __u = node( __a );
+        __u32  __v = node( __b );
+
+        if( __u == __v )
+          { return __a; }
+
+        __u32  __l = _M_tin[__u];
+        __u32  __r = _M_tin[__v];
+        if( __l > __r )
+          { std::swap( __l, __r ); }
+
+        /** Минимум на отрезке [l + 1, r] - двумя перекрывающимися
+         *  отрезками длины 2^k.
+         */
+        __l++;
+        __u32  __k = 31 - __builtin_clz( __r - __l + 1 );
+        __u32  __w = earlier( _M_sparse[__k][__l], _M_sparse[__k][__r + 1 - ( 1u << __k )] );
+        return _M_tree->number( __w );
+        }
+//--------------------------------------------------------------------
+      auto
+      subtree_size( __s32 __a ) const -> __u32
+        {
+        __u32  __u = node( __a );
+        return _M_tout[__u] - _M_tin[__u] + 1;
+        }
+//--------------------------------------------------------------------
+// Прибавление __delta к значению вершины __a.
+      auto
+      add_value( __s32 __a, const _Val& __delta ) -> void
+        {
+        __u32  __n = static_cast<__u32>( _M_order.size() );
+        for( __u32 __i = _M_tin[node( __a )] + 1; __i <= __n; __i += __i & ( 0u - __i ) )
+          { _M_fenwick[__i] += __delta; }
+        }
+//--------------------------------------------------------------------
+      auto
+      value( __s32 __a ) const -> _Val
+        {
+        __u32  __t = _M_tin[node( __a )];
+        return prefix_sum( __t + 1 ) - prefix_sum( __t );
+        }
+//--------------------------------------------------------------------
+      auto
+      set_value( __s32 __a, const _Val& __v ) -> void
+        { add_value( __a, __v - value( __a ) ); }
+//--------------------------------------------------------------------
+// Сумма значений по поддереву вершины __a.
+      auto
+      subtree_sum( __s32 __a ) const -> _Val
+        {
+        __u32  __u = node( __a );
+        return prefix_sum( _M_tout[__u] + 1 ) - prefix_sum( _M_tin[__u] );
+        }
+
+    }; // class ptree_index
+
+  } // namespace ptl
+
+#endif // __PTL_PTREE_INDEX_H__
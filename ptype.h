@@ -9,6 +9,9 @@
 #if !defined( __PTL_PTYPE_H__ )
 #define __PTL_PTYPE_H__
 
+// __s8  - 127
+// __u8  - 255
+//
 // __s16 - 32 767
 // __u16 - 65 535
 //
@@ -21,6 +24,9 @@
 namespace ptl
   {
 
+  typedef signed char             __s8;
+  typedef unsigned char           __u8;
+
   typedef signed short int        __s16;
   typedef unsigned short int      __u16;
 
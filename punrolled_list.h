@@ -0,0 +1,394 @@
+// -*- C++ -*-
+
+/*
+ * Copyright (c) S-Patriarch, 2023
+ *
+ * Описание библиотеки для развернутого связанного списка данных.
+ */
+
+/**
+ *  (PTL) Patriarch library : punrolled_list.h
+ */
+
+#pragma once
+#if !defined( __PTL_PUNROLLED_LIST_H__ )
+#define __PTL_PUNROLLED_LIST_H__
+
+#if !defined( __PTL_PTYPE_H__ )
+#include "ptype.h"
+#endif
+
+#if !defined( __PTL_PEXCEPT_H__ )
+#include "pexcept.h"
+#endif
+
+#include <iostream>
+#include <new>
+#include <utility>
+
+/*
+ * Развернутый связанный список данных. Узел хранит до _Bp элементов
+ * подряд, поэтому поиск и вывод читают память блоками, а переход по
+ * указателю нужен один раз на _Bp элементов. Интерфейс совпадает с
+ * plist, и списки взаимозаменяемы через typedef.
+ *
+ * Вставка в заполненный узел делит его пополам. После удаления узел,
+ * заполненный меньше чем наполовину, сливается со следующим, если их
+ * элементы помещаются в один узел.
+ *
+ * Методы:
+ *   - push() - вставка в конец списка за O(1)
+ *   - push_front() - вставка в начало списка
+ *   - insert() - вставка в середину списка
+ *   - remove() - удаление элемента списка по значению
+ *   - remove_position() - удаление элемента списка по позиции
+ *   - show() - вывод содержимого списка через пробел
+ *   - clear() - удаление всего списка
+ *   - find() - поиск элемента в списке (найден - true, нет - false)
+ *   - at() - элемент по позиции (узлы пропускаются целиком)
+ *   - size() - количество элементов списка
+ *
+ * @code
+ *   ptl::punrolled_list<ptl::__s32> list;
+ *   list.push( 1 );
+ *   list.insert( 0, 2 );
+ * @endcode
+ */
+
+namespace ptl
+  {
+//////////////////////////////////////////////////////////////////////
+  template <typename _Tp, __u32 _Bp = 16>
+  class punrolled_list
+    {
+      static_assert( _Bp >= 2, "Узел должен вмещать хотя бы два элемента." );
+
+    private:
+      /*
+       * Узел: неинициализированная память под _Bp элементов, из
+       * которых заняты первые _M_count.
+       */
+      struct _Node
+        {
+        alignas( _Tp ) unsigned char  _M_storage[sizeof( _Tp ) * _Bp];
+        __u32                         _M_count{ 0 };
+        _Node*                        _M_next{ nullptr };
+
+        auto
+        data() -> _Tp*
+          { return reinterpret_cast<_Tp*>( _M_storage ); }
+        };
+
+      _Node*  _M_head; // Первый узел списка.
+      _Node*  _M_tail; // Последний узел списка.
+      __u32   _M_size; // Количество элементов.
+
+//--------------------------------------------------------------------
+      // Вставка __data в узел __node на место __i со сдвигом вправо.
+      // В узле должно быть свободное место.
+      static auto
+      node_insert( _Node* __node, __u32 __i, const _Tp& __data ) -> void
+        {
+        _Tp*  __a = __node->data();
+
+        if( __i == __node->_M_count )
+          { new( __a + __i ) _Tp( __data ); }
+        else
+          {
+          _Tp  __copy( __data ); // __data может лежать в этом же узле
+
+          new( __a + __node->_M_count ) _Tp( std::move( __a[__node->_M_count - 1] ) );
+          for( __u32 __j = __node->_M_count - 1; __j > __i; __j-- )
+            { __a[__j] = std::move( __a[__j - 1] ); }
+          __a[__i] = std::move( __copy );
+          }
+
+        __node->_M_count++;
+        }
+//--------------------------------------------------------------------
+      // Удаление элемента __i узла __node со сдвигом влево.
+      static auto
+      node_erase( _Node* __node, __u32 __i ) -> void
+        {
+        _Tp*  __a = __node->data();
+
+        for( __u32 __j = __i; __j + 1 < __node->_M_count; __j++ )
+          { __a[__j] = std::move( __a[__j + 1] ); }
+
+        __node->_M_count--;
+        __a[__node->_M_count].~_Tp();
+        }
+//--------------------------------------------------------------------
+      // Перенос элементов узла __from начиная с __i в конец узла __to.
+      static auto
+      node_move_tail( _Node* __from, __u32 __i, _Node* __to ) -> void
+        {
+        _Tp*  __src = __from->data();
+        _Tp*  __dst = __to->data();
+
+        for( __u32 __j = __i; __j < __from->_M_count; __j++ )
+          {
+          new( __dst + __to->_M_count++ ) _Tp( std::move( __src[__j] ) );
+          __src[__j].~_Tp();
+          }
+
+        __from->_M_count = __i;
+        }
+//--------------------------------------------------------------------
+      // Новый пустой узел после __node (nullptr - в начало списка).
+      auto
+      link_after( _Node* __node ) -> _Node*
+        {
+        _Node*  __fresh = new _Node;
+
+        if( __node == nullptr )
+          {
+          __fresh->_M_next = _M_head;
+          _M_head = __fresh;
+          }
+        else
+          {
+          __fresh->_M_next = __node->_M_next;
+          __node->_M_next  = __fresh;
+          }
+
+        if( _M_tail == __node )
+          { _M_tail = __fresh; }
+
+        return __fresh;
+        }
+//--------------------------------------------------------------------
+      // Исключение пустого узла __node, следующего за __prev.
+      auto
+      unlink( _Node* __prev, _Node* __node ) -> void
+        {
+        if( __prev == nullptr )
+          { _M_head = __node->_M_next; }
+        else
+          { __prev->_M_next = __node->_M_next; }
+
+        if( _M_tail == __node )
+          { _M_tail = __prev; }
+
+        delete __node;
+        }
+//--------------------------------------------------------------------
+      // Удаление элемента __i узла __node с исключением опустевшего
+      // узла или слиянием недозаполненного со следующим.
+      auto
+      erase_at( _Node* __prev, _Node* __node, __u32 __i ) -> void
+        {
+        node_erase( __node, __i );
+        _M_size--;
+
+        if( __node->_M_count == 0 )
+          {
+          unlink( __prev, __node );
+          return;
+          }
+
+        _Node*  __next = __node->_M_next;
+
+        if( __node->_M_count < _Bp / 2
+            && __next != nullptr
+            && __node->_M_count + __next->_M_count <= _Bp )
+          {
+          node_move_tail( __next, 0, __node );
+          unlink( __node, __next );
+          }
+        }
+//--------------------------------------------------------------------
+      // Поиск узла с элементом __position: узлы пропускаются целиком.
+      // __position должен быть меньше size().
+      auto
+      locate( __u32 __position, _Node*& __prev, __u32& __i ) const -> _Node*
+        {
+        _Node*  __node = _M_head;
+        __prev = nullptr;
+
+        while( __position >= __node->_M_count )
+          {
+          __position -= __node->_M_count;
+          __prev = __node;
+          __node = __node->_M_next;
+          }
+
+        __i = __position;
+        return __node;
+        }
+
+    public:
+      punrolled_list()
+        : _M_head( nullptr ), _M_tail( nullptr ), _M_size( 0 )
+        { }
+
+      punrolled_list( const punrolled_list& ) = delete;
+
+      punrolled_list&
+      operator=( const punrolled_list& ) = delete;
+
+      ~punrolled_list() noexcept
+        { clear(); }
+//--------------------------------------------------------------------
+      auto
+      push( _Tp __data ) -> void
+        {
+        if( _M_tail == nullptr || _M_tail->_M_count == _Bp )
+          { link_after( _M_tail ); }
+
+        node_insert( _M_tail, _M_tail->_M_count, __data );
+        _M_size++;
+        }
+//--------------------------------------------------------------------
+      auto
+      push_front( _Tp __data ) -> void
+        {
+        if( _M_head == nullptr || _M_head->_M_count == _Bp )
+          { link_after( nullptr ); }
+
+        node_insert( _M_head, 0, __data );
+        _M_size++;
+        }
+//--------------------------------------------------------------------
+// Вставка перед элементом __position; при __position >= size() -
+// в конец списка, как в plist.
+      auto
+      insert( __u32 __position, _Tp __data ) -> void
+        {
+        if( __position >= _M_size )
+          {
+          push( __data );
+          return;
+          }
+
+        _Node*  __prev;
+        __u32   __i;
+        _Node*  __node = locate( __position, __prev, __i );
+
+        /** Заполненный узел делится пополам; вставка идет в ту
+         *  половину, где оказалась позиция.
+         */
+        if( __node->_M_count == _Bp )
+          {
+          _Node*  __half = link_after( __node );
+          node_move_tail( __node, _Bp / 2, __half );
+
+          if( __i > _Bp / 2 )
+            {
+            __i -= _Bp / 2;
+            __node = __half;
+            }
+          }
+
+        node_insert( __node, __i, __data );
+        _M_size++;
+        }
+//--------------------------------------------------------------------
+// Удаление первого элемента, равного __data.
+      auto
+      remove( _Tp __data ) -> void
+        {
+        _Node*  __prev = nullptr;
+
+        for( _Node* __node = _M_head; __node != nullptr; __node = __node->_M_next )
+          {
+          _Tp*  __a = __node->data();
+
+          for( __u32 __i{ 0 }; __i < __node->_M_count; __i++ )
+            {
+            if( __a[__i] == __data )
+              {
+              erase_at( __prev, __node, __i );
+              return;
+              }
+            }
+
+          __prev = __node;
+          }
+        }
+//--------------------------------------------------------------------
+      auto
+      remove_position( __u32 __position ) -> void
+        {
+        if( __position >= _M_size )
+          return;
+
+        _Node*  __prev;
+        __u32   __i;
+        _Node*  __node = locate( __position, __prev, __i );
+
+        erase_at( __prev, __node, __i );
+        }
+//--------------------------------------------------------------------
+      auto
+      show() -> void
+        {
+        for( _Node* __node = _M_head; __node != nullptr; __node = __node->_M_next )
+          {
+          for( __u32 __i{ 0 }; __i < __node->_M_count; __i++ )
+            {
+            std::cout << __node->data()[__i]
+                      << " ";
+            }
+          }
+        }
+//--------------------------------------------------------------------
+      auto
+      clear() -> void
+        {
+        _Node*  __node = _M_head;
+
+        while( __node != nullptr )
+          {
+          _Node*  __next = __node->_M_next;
+
+          for( __u32 __i{ 0 }; __i < __node->_M_count; __i++ )
+            { __node->data()[__i].~_Tp(); }
+          delete __node;
+
+          __node = __next;
+          }
+
+        _M_head = nullptr;
+        _M_tail = nullptr;
+        _M_size = 0;
+        }
+//--------------------------------------------------------------------
+      auto
+      find( _Tp __data ) -> bool
+        {
+        for( _Node* __node = _M_head; __node != nullptr; __node = __node->_M_next )
+          {
+          const _Tp*  __a = __node->data();
+
+          for( __u32 __i{ 0 }; __i < __node->_M_count; __i++ )
+            {
+            if( __a[__i] == __data )
+              return true;
+            }
+          }
+
+        return false;
+        }
+//--------------------------------------------------------------------
+// Элемент по позиции.
+      auto
+      at( __u32 __position ) -> _Tp&
+        {
+        if( __position >= _M_size )
+          { throw pexception( "E: Позиция за пределами списка." ); }
+
+        _Node*  __prev;
+        __u32   __i;
+        return locate( __position, __prev, __i )->data()[__i];
+        }
+//--------------------------------------------------------------------
+      auto
+      size() const -> __u32
+        { return _M_size; }
+
+    }; // class punrolled_list
+
+  } // namespace ptl
+
+#endif // __PTL_PUNROLLED_LIST_H__